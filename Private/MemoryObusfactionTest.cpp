@@ -3,9 +3,14 @@
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
 
 // SafeVar
 #include "../header/SafeVar.hpp"
+#include "../header/SafeJournal.hpp"
 
 struct PlayerPosition
 {
@@ -75,8 +80,129 @@ void TestSymmetry ( )
     }
 }
 
-int main ( )
+// Two batches with identical records in one journal file must not encrypt to the same bytes
+bool TestJournalKeystream ( )
 {
+    const char* path = "journal_keystream_test.bin";
+    std::array<uint8_t, 32> journalKey = { 0x9f, 0x5d, 0x21, 0x6c };
+    std::array<uint8_t, 16> chainKey = { 0x42 };
+    uint8_t mask [ 16 ] = { };
+    uint8_t cipher [ 16 ] = { };
+
+    {
+        SafeJournal journal ( path, journalKey, chainKey );
+        journal.Append ( 1, 1, mask, cipher, sizeof ( cipher ) );
+        journal.Flush ( );
+        journal.Append ( 1, 1, mask, cipher, sizeof ( cipher ) );
+        journal.Flush ( );
+    }
+
+    // Skip magic and salt, then read both frames: [seq u64][length u32][count u32][sealed][tag u64]
+    std::ifstream in ( path, std::ios::binary );
+    in.seekg ( 4 + 8 );
+    std::vector<uint8_t> sealed [ 2 ];
+    for ( auto& frame : sealed ) {
+        uint64_t seq = 0, tag = 0;
+        uint32_t length = 0, count = 0;
+        in.read ( reinterpret_cast< char* >( &seq ), 8 );
+        in.read ( reinterpret_cast< char* >( &length ), 4 );
+        in.read ( reinterpret_cast< char* >( &count ), 4 );
+        frame.resize ( length );
+        in.read ( reinterpret_cast< char* >( frame.data ( ) ), length );
+        in.read ( reinterpret_cast< char* >( &tag ), 8 );
+    }
+    bool framesRead = static_cast< bool >( in );
+    in.close ( );
+
+    size_t records = 0;
+    bool verified = SafeJournal::ReadFile ( path, journalKey, chainKey, [ &records ] ( const SafeJournalRecord& ) { ++records; } );
+    std::remove ( path );
+
+    bool passed = framesRead && verified && records == 2 && !sealed [ 0 ].empty ( )
+        && sealed [ 0 ].size ( ) == sealed [ 1 ].size ( ) && sealed [ 0 ] != sealed [ 1 ];
+    std::cout << ( passed ? "Journal Keystream Test Passed!\n" : "Journal Keystream Test Failed!\n" );
+    return passed;
+}
+
+// Average nanoseconds per Set and per Get over `frames` frames of `perFrame` variables each.
+// With frameEnd set, the arena is closed at the end of every frame.
+void BenchmarkFrames ( const char* label, size_t perFrame, size_t frames, bool frameEnd, bool pads )
+{
+    std::vector<SafeVar<uint32_t>> vars ( perFrame );
+    if ( pads ) {
+        for ( auto& var : vars ) var.EnablePad ( );
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration setTime { }, getTime { };
+    uint64_t sink = 0;
+
+    for ( size_t frame = 0; frame < frames; ++frame ) {
+        auto start = Clock::now ( );
+        for ( size_t i = 0; i < perFrame; ++i ) {
+            vars [ i ].Set ( static_cast< uint32_t >( frame + i ) );
+        }
+        auto middle = Clock::now ( );
+        for ( size_t i = 0; i < perFrame; ++i ) {
+            sink += vars [ i ].Get ( );
+        }
+        getTime += Clock::now ( ) - middle;
+        setTime += middle - start;
+
+        if ( frameEnd ) SafeArena::Instance ( ).EndFrame ( );
+    }
+
+    double operations = static_cast< double >( perFrame * frames );
+    std::cout << label
+        << " set " << std::chrono::duration<double, std::nano> ( setTime ).count ( ) / operations << " ns"
+        << ", get " << std::chrono::duration<double, std::nano> ( getTime ).count ( ) / operations << " ns"
+        << " (checksum " << sink << ")\n";
+}
+
+// Hot-path latency with and without batched arena protection
+void RunBenchmark ( )
+{
+    const size_t perFrame = 1000;
+    const size_t frames = 200;
+    SafeArena& arena = SafeArena::Instance ( );
+
+    arena.SetBatchedProtection ( false );
+    BenchmarkFrames ( "unprotected arena:", perFrame, frames, false, false );
+    BenchmarkFrames ( "unprotected arena + pads:", perFrame, frames, false, true );
+
+    uint64_t protectCalls = arena.ProtectCalls ( );
+    arena.SetBatchedProtection ( true );
+    BenchmarkFrames ( "batched protection:", perFrame, frames, true, false );
+    BenchmarkFrames ( "batched protection + pads:", perFrame, frames, true, true );
+    arena.SetBatchedProtection ( false );
+
+    std::cout << "VirtualProtect calls: " << arena.ProtectCalls ( ) - protectCalls
+        << " over " << 2 * frames << " frames, " << arena.ChunkCount ( ) << " arena chunk(s)\n";
+}
+
+int main ( int argc, char** argv )
+{
+    if ( argc > 1 && std::strcmp ( argv [ 1 ], "--bench" ) == 0 ) {
+        try {
+            RunBenchmark ( );
+            return 0;
+        }
+        catch ( const std::exception& e ) {
+            std::cerr << "Error: " << e.what ( ) << "\n";
+            return 1;
+        }
+    }
+
+    if ( argc > 1 && std::strcmp ( argv [ 1 ], "--journal" ) == 0 ) {
+        try {
+            return TestJournalKeystream ( ) ? 0 : 1;
+        }
+        catch ( const std::exception& e ) {
+            std::cerr << "Error: " << e.what ( ) << "\n";
+            return 1;
+        }
+    }
+
     try {
         // Create player stats for testing
         PlayerStats player ( 100, 0, 10.0f, 20.0f, 30.0f );
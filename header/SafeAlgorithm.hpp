@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SafeVar.hpp"
+#include "SafeParallel.hpp"
+
+/**
+ * @file    SafeAlgorithm.hpp
+ * @brief   Key-extraction sort and search over ranges containing SafeVars.
+ *
+ * std::sort over SafeVars calls the comparison operators, and each of those runs two full
+ * Get() pipelines including a re-key. The algorithms here decrypt every key exactly once
+ * (SafeVar::Peek, no re-key) into a scratch buffer that is wiped afterwards, order a
+ * permutation on the plaintext keys and then move the elements into place, so ciphertext is
+ * moved but never re-encrypted. Key extraction runs on SafeBulk chunks for large inputs.
+ *
+ * Ranges may hold SafeVar<K>, SafeVar<K>* or arbitrary structs; for structs pass a projection
+ * returning the SafeVar<K> (or pointer) that acts as the sort key.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+namespace safevar
+{
+	namespace detail
+	{
+		template<typename T> struct SafeVarValue;
+		template<typename T> struct SafeVarValue<SafeVar<T>> { using type = T; };
+		template<typename T> struct SafeVarValue<SafeVar<T>*> { using type = T; };
+		template<typename T> struct SafeVarValue<const SafeVar<T>*> { using type = T; };
+
+		template<typename T> const SafeVar<T>& Deref ( const SafeVar<T>& var ) { return var; }
+		template<typename T> const SafeVar<T>& Deref ( const SafeVar<T>* var ) { return *var; }
+
+		struct Identity
+		{
+			template<typename E> E& operator()( E& element ) const { return element; }
+		};
+
+		template<typename It, typename Proj>
+		using KeyType = typename SafeVarValue<typename std::decay<decltype( std::declval<Proj&> ( )( *std::declval<It&> ( ) ) )>::type>::type;
+
+		template<typename K>
+		K PeekOrThrow ( const SafeVar<K>& var )
+		{
+			K value;
+			SafeVarStatus status = var.Peek ( value );
+			if ( status != SafeVarStatus::Ok ) {
+				throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+			}
+			return value;
+		}
+
+		// Decrypts each key once into keys[i] = (key, original index)
+		template<typename It, typename Proj, typename K>
+		void ExtractKeys ( It first, size_t count, Proj& proj, std::vector<std::pair<K, size_t>>& keys, const SafeBulkOptions& options )
+		{
+			keys.resize ( count );
+			std::pair<K, size_t>* out = keys.data ( );
+			SafeBulk::ForEachChunk ( count, options, [ first, out, &proj ] ( size_t begin, size_t end ) {
+				for ( size_t i = begin; i < end; ++i ) {
+					out [ i ].first = PeekOrThrow ( Deref ( proj ( first [ i ] ) ) );
+					out [ i ].second = i;
+				}
+			} );
+		}
+
+		template<typename K>
+		void WipeKeys ( std::vector<std::pair<K, size_t>>& keys )
+		{
+			if ( !keys.empty ( ) ) {
+				SecureWipe ( keys.data ( ), keys.size ( ) * sizeof ( keys [ 0 ] ) );
+			}
+		}
+
+		// Moves first[keys[i].second] to position i, following permutation cycles (n moves total)
+		template<typename It, typename K>
+		void ApplyPermutation ( It first, const std::vector<std::pair<K, size_t>>& keys )
+		{
+			using Element = typename std::iterator_traits<It>::value_type;
+			std::vector<bool> placed ( keys.size ( ), false );
+
+			for ( size_t start = 0; start < keys.size ( ); ++start ) {
+				if ( placed [ start ] || keys [ start ].second == start ) {
+					placed [ start ] = true;
+					continue;
+				}
+
+				Element carried ( std::move ( first [ start ] ) );
+				size_t position = start;
+				for ( ;; ) {
+					size_t source = keys [ position ].second;
+					placed [ position ] = true;
+					if ( source == start ) {
+						first [ position ] = std::move ( carried );
+						break;
+					}
+					first [ position ] = std::move ( first [ source ] );
+					position = source;
+				}
+			}
+		}
+
+		template<typename K, typename Comp>
+		struct KeyLess
+		{
+			Comp& comp;
+			bool operator()( const std::pair<K, size_t>& a, const std::pair<K, size_t>& b ) const
+			{
+				if ( comp ( a.first, b.first ) ) return true;
+				if ( comp ( b.first, a.first ) ) return false;
+				return a.second < b.second;
+			}
+		};
+	}
+
+	// Stable sort by decrypted key: O(n) decryptions, O(n log n) plaintext comparisons, n moves
+	template<typename It, typename Comp, typename Proj>
+	void sort ( It first, It last, Comp comp, Proj proj, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		using K = detail::KeyType<It, Proj>;
+		std::vector<std::pair<K, size_t>> keys;
+		try {
+			detail::ExtractKeys ( first, static_cast< size_t >( last - first ), proj, keys, options );
+			std::sort ( keys.begin ( ), keys.end ( ), detail::KeyLess<K, Comp> { comp } );
+			detail::ApplyPermutation ( first, keys );
+		}
+		catch ( ... ) {
+			detail::WipeKeys ( keys );
+			throw;
+		}
+		detail::WipeKeys ( keys );
+	}
+
+	template<typename It, typename Comp>
+	void sort ( It first, It last, Comp comp, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		safevar::sort ( first, last, comp, detail::Identity ( ), options );
+	}
+
+	template<typename It>
+	void sort ( It first, It last, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		using K = detail::KeyType<It, detail::Identity>;
+		safevar::sort ( first, last, std::less<K> ( ), detail::Identity ( ), options );
+	}
+
+	// Places the nth element where a full sort would put it, with smaller keys before it
+	template<typename It, typename Comp, typename Proj>
+	void nth_element ( It first, It nth, It last, Comp comp, Proj proj, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		if ( nth == last ) return;
+
+		using K = detail::KeyType<It, Proj>;
+		std::vector<std::pair<K, size_t>> keys;
+		try {
+			detail::ExtractKeys ( first, static_cast< size_t >( last - first ), proj, keys, options );
+			std::nth_element ( keys.begin ( ), keys.begin ( ) + ( nth - first ), keys.end ( ), detail::KeyLess<K, Comp> { comp } );
+			detail::ApplyPermutation ( first, keys );
+		}
+		catch ( ... ) {
+			detail::WipeKeys ( keys );
+			throw;
+		}
+		detail::WipeKeys ( keys );
+	}
+
+	template<typename It, typename Comp>
+	void nth_element ( It first, It nth, It last, Comp comp, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		safevar::nth_element ( first, nth, last, comp, detail::Identity ( ), options );
+	}
+
+	template<typename It>
+	void nth_element ( It first, It nth, It last, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		using K = detail::KeyType<It, detail::Identity>;
+		safevar::nth_element ( first, nth, last, std::less<K> ( ), detail::Identity ( ), options );
+	}
+
+	// Binary search on a sorted range: one Peek per probe, no copies and no re-keying
+	template<typename It, typename K, typename Comp, typename Proj>
+	It lower_bound ( It first, It last, const K& value, Comp comp, Proj proj )
+	{
+		auto count = last - first;
+		while ( count > 0 ) {
+			auto step = count / 2;
+			It mid = first + step;
+			K probe = detail::PeekOrThrow ( detail::Deref ( proj ( *mid ) ) );
+			bool less = comp ( probe, value );
+			SecureWipe ( &probe, sizeof ( probe ) );
+			if ( less ) {
+				first = mid + 1;
+				count -= step + 1;
+			}
+			else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	template<typename It, typename K, typename Comp>
+	It lower_bound ( It first, It last, const K& value, Comp comp )
+	{
+		return safevar::lower_bound ( first, last, value, comp, detail::Identity ( ) );
+	}
+
+	template<typename It, typename K>
+	It lower_bound ( It first, It last, const K& value )
+	{
+		return safevar::lower_bound ( first, last, value, std::less<K> ( ), detail::Identity ( ) );
+	}
+
+	template<typename It, typename K, typename Comp, typename Proj>
+	It upper_bound ( It first, It last, const K& value, Comp comp, Proj proj )
+	{
+		auto count = last - first;
+		while ( count > 0 ) {
+			auto step = count / 2;
+			It mid = first + step;
+			K probe = detail::PeekOrThrow ( detail::Deref ( proj ( *mid ) ) );
+			bool notGreater = !comp ( value, probe );
+			SecureWipe ( &probe, sizeof ( probe ) );
+			if ( notGreater ) {
+				first = mid + 1;
+				count -= step + 1;
+			}
+			else {
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	template<typename It, typename K, typename Comp>
+	It upper_bound ( It first, It last, const K& value, Comp comp )
+	{
+		return safevar::upper_bound ( first, last, value, comp, detail::Identity ( ) );
+	}
+
+	template<typename It, typename K>
+	It upper_bound ( It first, It last, const K& value )
+	{
+		return safevar::upper_bound ( first, last, value, std::less<K> ( ), detail::Identity ( ) );
+	}
+
+	template<typename It, typename K, typename Comp, typename Proj>
+	bool binary_search ( It first, It last, const K& value, Comp comp, Proj proj )
+	{
+		It it = safevar::lower_bound ( first, last, value, comp, proj );
+		if ( it == last ) return false;
+		K probe = detail::PeekOrThrow ( detail::Deref ( proj ( *it ) ) );
+		bool found = !comp ( value, probe );
+		SecureWipe ( &probe, sizeof ( probe ) );
+		return found;
+	}
+
+	template<typename It, typename K, typename Comp>
+	bool binary_search ( It first, It last, const K& value, Comp comp )
+	{
+		return safevar::binary_search ( first, last, value, comp, detail::Identity ( ) );
+	}
+
+	template<typename It, typename K>
+	bool binary_search ( It first, It last, const K& value )
+	{
+		return safevar::binary_search ( first, last, value, std::less<K> ( ), detail::Identity ( ) );
+	}
+}
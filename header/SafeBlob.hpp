@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "SafeVar.hpp"
+#include "SafeParallel.hpp"
+
+/**
+ * @file    SafeBlob.hpp
+ * @brief   Batch validation of client-submitted sealed SafeVar blobs.
+ *
+ * SafeBlobValidator<T> checks many SafeSealedBlob buffers (see SafeVar.hpp) under one server key:
+ * framing, SipHash tag, decryption and an optional value check, with one SafeBlobStatus per blob
+ * and no exceptions for bad input.
+ *
+ * For values of up to 64 bytes the blobs are processed four at a time: one SIMD pass yields
+ * keystream block 0 (the tag key) for four nonces and a second one the payload block, instead
+ * of two scalar ChaCha20 blocks per blob. Larger values fall back to SafeSealedBlob::Open().
+ * With SafeBulkOptions the batch is additionally split across an executor.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+template<typename T>
+class SafeBlobValidator
+{
+	static_assert( std::is_trivially_copyable<T>::value, "Sealed blobs hold trivially copyable values." );
+
+public:
+	static constexpr size_t VALUE_SIZE = sizeof ( T );
+	static constexpr size_t LANES = 4;
+
+	// Return false to reject an authentic value (range checks, game rules)
+	using ValueCheck = std::function<bool ( const T& )>;
+
+	// Accepts values in [lo, hi]
+	static ValueCheck Range ( T lo, T hi )
+	{
+		return [ lo, hi ] ( const T& value ) { return !( value < lo ) && !( hi < value ); };
+	}
+
+private:
+	std::array<uint8_t, 32> key;
+	ValueCheck check;
+
+	// Value check and hand-off for one decrypted payload; wipes plain
+	SafeBlobStatus Accept ( uint8_t* plain, SafeVar<T>* target ) const
+	{
+		SafeBlobStatus status = SafeBlobStatus::Ok;
+		if ( check ) {
+			T value;
+			std::memcpy ( &value, plain, VALUE_SIZE );
+			if ( !check ( value ) ) status = SafeBlobStatus::Rejected;
+			SecureWipe ( &value, VALUE_SIZE );
+		}
+		if ( status == SafeBlobStatus::Ok && target ) {
+			target->SetFromBytes ( plain );
+		}
+		SecureWipe ( plain, VALUE_SIZE );
+		return status;
+	}
+
+	// Four framed blobs (fewer in the last group) through the lane kernel
+	void OpenLanes ( const uint8_t* const* blobs, const size_t* indices, size_t used, SafeBlobStatus* statuses, SafeVar<T>* const* targets ) const
+	{
+		const uint8_t* nonces [ LANES ];
+		for ( size_t lane = 0; lane < LANES; ++lane ) {
+			nonces [ lane ] = blobs [ indices [ lane < used ? lane : 0 ] ] + SafeSealedBlob::NONCE_OFFSET;
+		}
+
+		uint8_t block0 [ LANES * 64 ], block1 [ LANES * 64 ];
+		ChaCha20::KeystreamLanes ( key.data ( ), nonces, 0, block0 );
+		ChaCha20::KeystreamLanes ( key.data ( ), nonces, 1, block1 );
+
+		for ( size_t lane = 0; lane < used; ++lane ) {
+			size_t index = indices [ lane ];
+			const uint8_t* blob = blobs [ index ];
+			if ( !SafeSealedBlob::TagMatches ( block0 + lane * 64, blob, VALUE_SIZE ) ) {
+				statuses [ index ] = SafeBlobStatus::AuthenticationFailed;
+				continue;
+			}
+
+			uint8_t plain [ VALUE_SIZE ];
+			for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+				plain [ i ] = blob [ SafeSealedBlob::HEADER_SIZE + i ] ^ block1 [ lane * 64 + i ];
+			}
+			statuses [ index ] = Accept ( plain, targets ? targets [ index ] : nullptr );
+		}
+
+		SecureWipe ( block0, sizeof ( block0 ) );
+		SecureWipe ( block1, sizeof ( block1 ) );
+	}
+
+	void ValidateRange ( size_t begin, size_t end, const uint8_t* const* blobs, const size_t* lengths, SafeBlobStatus* statuses, SafeVar<T>* const* targets ) const
+	{
+		size_t group [ LANES ];
+		size_t used = 0;
+
+		for ( size_t i = begin; i < end; ++i ) {
+			statuses [ i ] = SafeSealedBlob::CheckFraming ( blobs [ i ], lengths [ i ], VALUE_SIZE );
+			if ( statuses [ i ] != SafeBlobStatus::Ok ) continue;
+
+			if ( VALUE_SIZE > 64 ) {
+				uint8_t plain [ VALUE_SIZE ];
+				statuses [ i ] = SafeSealedBlob::Open ( key.data ( ), blobs [ i ], lengths [ i ], plain, VALUE_SIZE );
+				if ( statuses [ i ] == SafeBlobStatus::Ok ) {
+					statuses [ i ] = Accept ( plain, targets ? targets [ i ] : nullptr );
+				}
+				continue;
+			}
+
+			group [ used++ ] = i;
+			if ( used == LANES ) {
+				OpenLanes ( blobs, group, used, statuses, targets );
+				used = 0;
+			}
+		}
+		if ( used ) OpenLanes ( blobs, group, used, statuses, targets );
+	}
+
+public:
+	explicit SafeBlobValidator ( const uint8_t* serverKey, ValueCheck valueCheck = ValueCheck ( ) )
+		: check ( std::move ( valueCheck ) )
+	{
+		std::memcpy ( key.data ( ), serverKey, key.size ( ) );
+	}
+
+	SafeBlobValidator ( const SafeBlobValidator& ) = delete;
+	SafeBlobValidator& operator=( const SafeBlobValidator& ) = delete;
+
+	~SafeBlobValidator ( ) { SecureWipe ( key.data ( ), key.size ( ) ); }
+
+	// Single blob; target (optional) receives the value on Ok
+	SafeBlobStatus Open ( const uint8_t* blob, size_t length, SafeVar<T>* target = nullptr ) const
+	{
+		SafeBlobStatus status;
+		ValidateRange ( 0, 1, &blob, &length, &status, target ? &target : nullptr );
+		return status;
+	}
+
+	/**
+	 * Validate count blobs; statuses[i] receives the result for blobs[i]. When targets is given,
+	 * every accepted value is stored into targets[i] (null entries only validate). Pass options
+	 * to spread the batch over an executor. Returns the number of accepted blobs.
+	 */
+	size_t Validate ( const uint8_t* const* blobs, const size_t* lengths, size_t count, SafeBlobStatus* statuses,
+		SafeVar<T>* const* targets = nullptr, const SafeBulkOptions* options = nullptr ) const
+	{
+		if ( options ) {
+			SafeBulk::ForEachChunk ( count, *options, [ & ] ( size_t begin, size_t end ) {
+				ValidateRange ( begin, end, blobs, lengths, statuses, targets );
+			} );
+		}
+		else {
+			ValidateRange ( 0, count, blobs, lengths, statuses, targets );
+		}
+
+		size_t accepted = 0;
+		for ( size_t i = 0; i < count; ++i ) {
+			accepted += statuses [ i ] == SafeBlobStatus::Ok ? 1 : 0;
+		}
+		return accepted;
+	}
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeClock.hpp
+ * @brief   Speedhack-resistant game clock with cheap reads.
+ *
+ * The clock's anchor (game time, QueryPerformanceCounter value and time scale) is stored in
+ * SafeVars. Now() does not touch them: it reads a copy of the anchor encrypted under a fresh
+ * keystream slice at every refresh (see SafeKeystream; the slice never spans two blocks) and
+ * extrapolates with the performance counter. A read costs one counter read and one keystream
+ * block, which the reading thread's block cache usually already holds.
+ *
+ * Every check interval the clock refreshes: it compares the elapsed performance-counter time
+ * against GetTickCount64, the system wall clock and the TSC. If the performance counter
+ * disagrees with at least two of the three references the interval is treated as a speedhack,
+ * the detection handler runs and the clock advances by the median reference instead. The
+ * cached anchor is also checked against the protected SafeVars to catch edits of the cache.
+ * The TSC becomes a reference once it has been calibrated over at least
+ * TSC_CALIBRATION_SECONDS of performance-counter time; until then it agrees by definition.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+struct SafeClockConfig
+{
+	double checkIntervalSeconds = 1.0;   // how often Now() triggers a refresh
+	double relativeTolerance = 0.05;     // allowed drift between sources, relative
+	double absoluteSlackSeconds = 0.05;  // allowed drift between sources, absolute (timer granularity)
+};
+
+class SafeClock
+{
+public:
+	enum class Detection : uint8_t
+	{
+		Speedhack,
+		CacheTampered
+	};
+
+	static constexpr double TSC_CALIBRATION_SECONDS = 0.5;
+
+	// Called on detection with the counter-derived and the reference elapsed seconds
+	using DetectionHandler = std::function<void ( Detection, double counterSeconds, double referenceSeconds )>;
+
+private:
+	struct Reference
+	{
+		uint64_t counter;
+		uint64_t tickMs;
+		uint64_t wall100ns;
+		uint64_t tsc;
+	};
+
+	// The anchor as it travels through the read cache
+	struct CachedAnchor
+	{
+		uint64_t time;
+		uint64_t scale;
+		uint64_t counter;
+	};
+
+	SafeClockConfig config;
+	double counterFrequency;
+	double tscFrequency = 0.0;
+	Reference calibrationStart;
+	uint64_t checkIntervalTicks;
+
+	// Authoritative anchor
+	SafeVar<double> anchorTime;
+	SafeVar<double> timeScale;
+	SafeVar<uint64_t> anchorCounter;
+
+	// Encrypted read cache and its keystream slice, published with a sequence lock
+	mutable std::atomic<uint32_t> sequence { 0 };
+	std::atomic<uint64_t> cachedTime { 0 };
+	std::atomic<uint64_t> cachedScale { 0 };
+	std::atomic<uint64_t> cachedCounter { 0 };
+	std::atomic<uint32_t> cacheEpoch { 0 };
+	std::atomic<uint64_t> cachePosition { 0 };
+
+	mutable std::mutex refreshMtx;
+	Reference lastReference;
+	std::atomic<uint32_t> detections { 0 };
+	DetectionHandler handler;
+
+	static uint64_t ReadCounter ( )
+	{
+		LARGE_INTEGER value;
+		QueryPerformanceCounter ( &value );
+		return static_cast< uint64_t >( value.QuadPart );
+	}
+
+	static Reference Sample ( )
+	{
+		Reference ref;
+		FILETIME wall;
+		ref.counter = ReadCounter ( );
+		ref.tickMs = GetTickCount64 ( );
+		GetSystemTimeAsFileTime ( &wall );
+		ref.wall100ns = ( static_cast< uint64_t >( wall.dwHighDateTime ) << 32 ) | wall.dwLowDateTime;
+		ref.tsc = __rdtsc ( );
+		return ref;
+	}
+
+	static uint64_t Bits ( double value )
+	{
+		uint64_t bits;
+		std::memcpy ( &bits, &value, sizeof ( bits ) );
+		return bits;
+	}
+
+	static double FromBits ( uint64_t bits )
+	{
+		double value;
+		std::memcpy ( &value, &bits, sizeof ( value ) );
+		return value;
+	}
+
+	void Publish ( double time, double scale, uint64_t counter )
+	{
+		CachedAnchor plain = { Bits ( time ), Bits ( scale ), counter };
+		CachedAnchor sealed;
+		uint32_t epoch;
+		uint64_t position;
+
+		// A slice inside one block costs readers a single keystream block; one retry suffices
+		SafeKeystream::Encrypt ( reinterpret_cast< const uint8_t* >( &plain ), reinterpret_cast< uint8_t* >( &sealed ), sizeof ( plain ), epoch, position );
+		if ( position % 64 + sizeof ( plain ) > 64 ) {
+			SafeKeystream::Encrypt ( reinterpret_cast< const uint8_t* >( &plain ), reinterpret_cast< uint8_t* >( &sealed ), sizeof ( plain ), epoch, position );
+		}
+		SecureWipe ( &plain, sizeof ( plain ) );
+
+		sequence.fetch_add ( 1, std::memory_order_acq_rel );
+		cachedTime.store ( sealed.time, std::memory_order_relaxed );
+		cachedScale.store ( sealed.scale, std::memory_order_relaxed );
+		cachedCounter.store ( sealed.counter, std::memory_order_relaxed );
+		cacheEpoch.store ( epoch, std::memory_order_relaxed );
+		cachePosition.store ( position, std::memory_order_relaxed );
+		sequence.fetch_add ( 1, std::memory_order_release );
+	}
+
+	void ReadCache ( double& time, double& scale, uint64_t& counter ) const
+	{
+		CachedAnchor sealed;
+		uint32_t epoch;
+		uint64_t position;
+		for ( ;; ) {
+			uint32_t before = sequence.load ( std::memory_order_acquire );
+			if ( before & 1 ) continue;
+
+			sealed.time = cachedTime.load ( std::memory_order_relaxed );
+			sealed.scale = cachedScale.load ( std::memory_order_relaxed );
+			sealed.counter = cachedCounter.load ( std::memory_order_relaxed );
+			epoch = cacheEpoch.load ( std::memory_order_relaxed );
+			position = cachePosition.load ( std::memory_order_relaxed );
+
+			std::atomic_thread_fence ( std::memory_order_acquire );
+			if ( sequence.load ( std::memory_order_relaxed ) == before ) break;
+		}
+
+		CachedAnchor plain;
+		SafeKeystream::Apply ( epoch, position, reinterpret_cast< const uint8_t* >( &sealed ), reinterpret_cast< uint8_t* >( &plain ), sizeof ( plain ) );
+		time = FromBits ( plain.time );
+		scale = FromBits ( plain.scale );
+		counter = plain.counter;
+		SecureWipe ( &plain, sizeof ( plain ) );
+	}
+
+	void Report ( Detection kind, double counterSeconds, double referenceSeconds )
+	{
+		detections.fetch_add ( 1, std::memory_order_relaxed );
+		if ( handler ) handler ( kind, counterSeconds, referenceSeconds );
+	}
+
+	bool Disagrees ( double counterSeconds, double referenceSeconds ) const
+	{
+		double allowed = config.absoluteSlackSeconds + config.relativeTolerance * std::max ( counterSeconds, referenceSeconds );
+		return std::fabs ( counterSeconds - referenceSeconds ) > allowed;
+	}
+
+	// Cross-checks the time sources since the last refresh and re-anchors. Caller holds refreshMtx.
+	bool Refresh ( )
+	{
+		bool clean = true;
+		Reference now = Sample ( );
+
+		double counterSeconds = static_cast< double >( now.counter - lastReference.counter ) / counterFrequency;
+		double tickSeconds = static_cast< double >( now.tickMs - lastReference.tickMs ) / 1000.0;
+		double wallSeconds = static_cast< double >( static_cast< int64_t >( now.wall100ns - lastReference.wall100ns ) ) / 1e7;
+		uint64_t tscDelta = now.tsc - lastReference.tsc;
+
+		// Calibrate the TSC once enough time has passed for a stable rate, then use it as a third
+		// reference. A short first interval (an early Check()) would give a noisy frequency.
+		double tscSeconds = counterSeconds;
+		if ( tscFrequency > 0.0 ) {
+			tscSeconds = static_cast< double >( tscDelta ) / tscFrequency;
+		}
+		else {
+			double calibrationSeconds = static_cast< double >( now.counter - calibrationStart.counter ) / counterFrequency;
+			if ( calibrationSeconds >= TSC_CALIBRATION_SECONDS ) {
+				tscFrequency = static_cast< double >( now.tsc - calibrationStart.tsc ) / calibrationSeconds;
+			}
+		}
+
+		double elapsed = counterSeconds;
+		int disagreements = ( Disagrees ( counterSeconds, tickSeconds ) ? 1 : 0 )
+			+ ( Disagrees ( counterSeconds, wallSeconds ) ? 1 : 0 )
+			+ ( Disagrees ( counterSeconds, tscSeconds ) ? 1 : 0 );
+		if ( disagreements >= 2 ) {
+			double references [ 3 ] = { tickSeconds, wallSeconds, tscSeconds };
+			std::sort ( references, references + 3 );
+			elapsed = std::max ( references [ 1 ], 0.0 );
+			Report ( Detection::Speedhack, counterSeconds, elapsed );
+			clean = false;
+		}
+
+		// The cache must still describe the protected anchor
+		double cachedAnchorTime, cachedAnchorScale;
+		uint64_t cachedAnchorCounter;
+		ReadCache ( cachedAnchorTime, cachedAnchorScale, cachedAnchorCounter );
+		double time = anchorTime.Get ( );
+		double scale = timeScale.Get ( );
+		uint64_t counter = anchorCounter.Get ( );
+		if ( Bits ( cachedAnchorTime ) != Bits ( time ) || Bits ( cachedAnchorScale ) != Bits ( scale ) || cachedAnchorCounter != counter ) {
+			Report ( Detection::CacheTampered, 0.0, 0.0 );
+			clean = false;
+		}
+
+		// Advance from the last verified reference point, not from the (possibly edited) cache
+		double verifiedTime = time + static_cast< double >( lastReference.counter - counter ) / counterFrequency * scale;
+		double newTime = verifiedTime + elapsed * scale;
+
+		anchorTime.Set ( newTime );
+		anchorCounter.Set ( now.counter );
+		Publish ( newTime, scale, now.counter );
+		lastReference = now;
+		return clean;
+	}
+
+public:
+	explicit SafeClock ( double scale = 1.0, const SafeClockConfig& clockConfig = SafeClockConfig ( ) )
+		: config ( clockConfig ), anchorTime ( 0.0 ), timeScale ( scale ), anchorCounter ( 0 )
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency ( &frequency );
+		counterFrequency = static_cast< double >( frequency.QuadPart );
+		checkIntervalTicks = static_cast< uint64_t >( config.checkIntervalSeconds * counterFrequency );
+
+		lastReference = Sample ( );
+		calibrationStart = lastReference;
+		anchorCounter.Set ( lastReference.counter );
+		Publish ( 0.0, scale, lastReference.counter );
+	}
+
+	SafeClock ( const SafeClock& ) = delete;
+	SafeClock& operator=( const SafeClock& ) = delete;
+
+	// Scaled game seconds since construction. Refreshes (and cross-checks) once per check interval.
+	double Now ( ) const
+	{
+		double time, scale;
+		uint64_t counter;
+		ReadCache ( time, scale, counter );
+
+		uint64_t current = ReadCounter ( );
+		if ( current - counter > checkIntervalTicks ) {
+			std::unique_lock<std::mutex> lock ( refreshMtx, std::try_to_lock );
+			if ( lock.owns_lock ( ) ) {
+				const_cast< SafeClock* >( this )->Refresh ( );
+				ReadCache ( time, scale, counter );
+				current = ReadCounter ( );
+			}
+		}
+
+		return time + static_cast< double >( current - counter ) / counterFrequency * scale;
+	}
+
+	int64_t NowNanoseconds ( ) const
+	{
+		return static_cast< int64_t >( Now ( ) * 1e9 );
+	}
+
+	// Change the time scale from now on (the clock stays continuous)
+	void SetTimeScale ( double scale )
+	{
+		std::lock_guard<std::mutex> lock ( refreshMtx );
+		Refresh ( );
+		timeScale.Set ( scale );
+		Publish ( anchorTime.Get ( ), scale, anchorCounter.Get ( ) );
+	}
+
+	double GetTimeScale ( ) const
+	{
+		double time, scale;
+		uint64_t counter;
+		ReadCache ( time, scale, counter );
+		return scale;
+	}
+
+	// Run the cross-check immediately; returns false if anything was detected
+	bool Check ( )
+	{
+		std::lock_guard<std::mutex> lock ( refreshMtx );
+		return Refresh ( );
+	}
+
+	void SetDetectionHandler ( DetectionHandler detectionHandler )
+	{
+		std::lock_guard<std::mutex> lock ( refreshMtx );
+		handler = std::move ( detectionHandler );
+	}
+
+	uint32_t DetectionCount ( ) const { return detections.load ( std::memory_order_relaxed ); }
+};
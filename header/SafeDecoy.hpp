@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeDecoy.hpp
+ * @brief   Plaintext decoy values packed on shared honeypot pages.
+ *
+ * SafeDecoyPages mirrors selected SafeVars as plaintext lookalikes, so memory scanners that
+ * search for a known value find the decoy instead of the (encrypted) real storage. Decoys
+ * take 8 to 64 bytes each and are packed densely on a few shared pages.
+ *
+ * Set() only stages the new value in the slot, behind a per-slot flag rather than the pages'
+ * mutex, so writes on different threads do not contend. Flush(), called once per frame, first
+ * checks every live slot against its keyed digest (catching foreign writes), then applies the
+ * staged values in one batch. With read-only pages a write from inside the process faults, and
+ * each page with staged values costs one VirtualProtect pair per flush. Detections are reported
+ * to SafeTamperLog with the owning SafeVar as source (kept current across moves and Swap), and
+ * to the detection handler. A released slot is zeroed on its page.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+class SafeDecoyPages : public SafeDecoySink
+{
+public:
+	static constexpr size_t PAGE_SIZE = 4096;
+	static constexpr size_t MAX_VALUE_SIZE = 64;
+
+	// Called from Flush() with the owning SafeVar and the decoy address that was modified
+	using DetectionHandler = std::function<void ( const void* owner, uintptr_t address )>;
+
+private:
+	static constexpr size_t SIZE_CLASSES = MAX_VALUE_SIZE / 8;
+	static constexpr size_t SLOTS_PER_CHUNK = 512;
+	static constexpr size_t MAX_SLOT_CHUNKS = 1024;
+
+	// Fields other than staged/dirty/busy change only under mtx
+	struct Slot
+	{
+		uint8_t* address;
+		uint32_t stride;
+		uint32_t size;
+		uint64_t digest;            // keyed digest of the bytes the page should hold
+		const void* owner;
+		bool live;
+		std::atomic<bool> dirty { false };
+		std::atomic<bool> busy { false };   // held while staged is written or read
+		std::array<uint8_t, MAX_VALUE_SIZE> staged;
+	};
+
+	std::vector<uint8_t*> pages;
+	size_t pageUsed = PAGE_SIZE;                        // bump offset within pages.back()
+
+	// Slots never move once created, so Stage() can index them while Attach() adds more
+	std::unique_ptr<Slot [ ]> slotChunks [ MAX_SLOT_CHUNKS ];
+	std::atomic<size_t> slotCount { 0 };
+
+	std::vector<uint32_t> freeSlots [ SIZE_CLASSES ];
+	bool readOnly;
+	DetectionHandler handler;
+	uint64_t detections = 0;
+	mutable std::mutex mtx;
+
+	static uint64_t Digest ( const uint8_t* data, size_t len )
+	{
+		return ComputeSipHash ( SafeProcessHashKey ( ).data ( ), data, len );
+	}
+
+	uint8_t* PageOf ( const uint8_t* address ) const
+	{
+		for ( uint8_t* page : pages ) {
+			if ( address >= page && address < page + PAGE_SIZE ) return page;
+		}
+		return nullptr;
+	}
+
+	void Protect ( uint8_t* page, DWORD protection )
+	{
+		DWORD previous;
+		if ( !VirtualProtect ( page, PAGE_SIZE, protection, &previous ) ) {
+			throw std::runtime_error ( "SafeDecoyPages: VirtualProtect failed" );
+		}
+	}
+
+	Slot& SlotAt ( uint32_t index ) const { return slotChunks [ index / SLOTS_PER_CHUNK ] [ index % SLOTS_PER_CHUNK ]; }
+
+	static void Lock ( Slot& slot )
+	{
+		while ( slot.busy.exchange ( true, std::memory_order_acquire ) ) {
+			std::this_thread::yield ( );
+		}
+	}
+
+	static void Unlock ( Slot& slot ) { slot.busy.store ( false, std::memory_order_release ); }
+
+	// Caller holds mtx
+	uint32_t AllocateSlot ( size_t size, const void* owner )
+	{
+		size_t sizeClass = ( size + 7 ) / 8 - 1;
+		uint32_t stride = static_cast< uint32_t >( ( sizeClass + 1 ) * 8 );
+
+		uint32_t index;
+		if ( !freeSlots [ sizeClass ].empty ( ) ) {
+			index = freeSlots [ sizeClass ].back ( );
+			freeSlots [ sizeClass ].pop_back ( );
+		}
+		else {
+			if ( pageUsed + stride > PAGE_SIZE ) {
+				void* page = VirtualAlloc ( NULL, PAGE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+				if ( !page ) throw std::runtime_error ( "SafeDecoyPages: page allocation failed" );
+				pages.push_back ( static_cast< uint8_t* >( page ) );
+				if ( readOnly ) Protect ( pages.back ( ), PAGE_READONLY );
+				pageUsed = 0;
+			}
+			size_t count = slotCount.load ( std::memory_order_relaxed );
+			if ( count == SLOTS_PER_CHUNK * MAX_SLOT_CHUNKS ) {
+				throw std::runtime_error ( "SafeDecoyPages: slot table exhausted" );
+			}
+			if ( count % SLOTS_PER_CHUNK == 0 ) {
+				slotChunks [ count / SLOTS_PER_CHUNK ].reset ( new Slot [ SLOTS_PER_CHUNK ] );
+			}
+			index = static_cast< uint32_t >( count );
+			SlotAt ( index ).address = pages.back ( ) + pageUsed;
+			SlotAt ( index ).stride = stride;
+			pageUsed += stride;
+			slotCount.store ( count + 1, std::memory_order_release );
+		}
+
+		Slot& slot = SlotAt ( index );
+		slot.size = static_cast< uint32_t >( size );
+		slot.digest = Digest ( slot.address, slot.size );
+		slot.owner = owner;
+		slot.live = true;
+		slot.dirty.store ( false, std::memory_order_relaxed );
+		return index;
+	}
+
+public:
+	explicit SafeDecoyPages ( bool readOnlyPages = true ) : readOnly ( readOnlyPages ) { }
+
+	SafeDecoyPages ( const SafeDecoyPages& ) = delete;
+	SafeDecoyPages& operator=( const SafeDecoyPages& ) = delete;
+
+	// Detach every SafeVar before destroying the pages
+	~SafeDecoyPages ( )
+	{
+		for ( uint8_t* page : pages ) {
+			VirtualFree ( page, 0, MEM_RELEASE );
+		}
+	}
+
+	// Mirror var on a decoy slot; the current value appears at the next Flush()
+	template<typename T>
+	void Attach ( SafeVar<T>& var )
+	{
+		static_assert( sizeof ( T ) <= MAX_VALUE_SIZE, "SafeDecoyPages supports values of at most 64 bytes." );
+
+		T current;
+		SafeVarStatus status = var.Peek ( current );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+
+		uint32_t index;
+		{
+			std::lock_guard<std::mutex> lock ( mtx );
+			index = AllocateSlot ( sizeof ( T ), &var );
+		}
+		var.AttachDecoy ( this, index );
+		Stage ( index, &current, sizeof ( T ) );
+		SecureWipe ( &current, sizeof ( T ) );
+	}
+
+	template<typename T>
+	void Detach ( SafeVar<T>& var ) { var.DetachDecoy ( ); }
+
+	// Hot path (every Set): only the slot's own flag, never the pages' mutex
+	void Stage ( uint32_t index, const void* value, size_t len ) override
+	{
+		Slot& slot = SlotAt ( index );
+		Lock ( slot );
+		std::memcpy ( slot.staged.data ( ), value, len );
+		slot.dirty.store ( true, std::memory_order_relaxed );
+		Unlock ( slot );
+	}
+
+	// Frees the slot and zeroes its bytes on the page, so the last value does not linger
+	void Release ( uint32_t index ) override
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		Slot& slot = SlotAt ( index );
+		Lock ( slot );
+		slot.dirty.store ( false, std::memory_order_relaxed );
+		SecureWipe ( slot.staged.data ( ), slot.staged.size ( ) );
+		Unlock ( slot );
+
+		uint8_t* page = PageOf ( slot.address );
+		if ( readOnly ) Protect ( page, PAGE_READWRITE );
+		SecureWipe ( slot.address, slot.stride );
+		if ( readOnly ) Protect ( page, PAGE_READONLY );
+
+		slot.live = false;
+		slot.owner = nullptr;
+		freeSlots [ slot.stride / 8 - 1 ].push_back ( index );
+	}
+
+	uintptr_t Address ( uint32_t index ) const override
+	{
+		return reinterpret_cast< uintptr_t >( SlotAt ( index ).address );
+	}
+
+	void SetOwner ( uint32_t index, const void* owner ) override
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		SlotAt ( index ).owner = owner;
+	}
+
+	void SetDetectionHandler ( DetectionHandler detectionHandler )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		handler = std::move ( detectionHandler );
+	}
+
+	// Frame-end batch: verify all live decoys, then publish staged values. Returns detections.
+	size_t Flush ( )
+	{
+		std::vector<std::pair<const void*, uintptr_t>> hits;
+		DetectionHandler notify;
+		{
+			std::lock_guard<std::mutex> lock ( mtx );
+
+			// An edited decoy becomes the new baseline, so each edit is reported once and the
+			// editor keeps seeing the value it wrote until the next legitimate Set()
+			size_t count = slotCount.load ( std::memory_order_relaxed );
+			for ( size_t i = 0; i < count; ++i ) {
+				Slot& slot = SlotAt ( static_cast< uint32_t >( i ) );
+				if ( !slot.live ) continue;
+				uint64_t digest = Digest ( slot.address, slot.size );
+				if ( digest != slot.digest ) {
+					hits.emplace_back ( slot.owner, reinterpret_cast< uintptr_t >( slot.address ) );
+					slot.digest = digest;
+				}
+			}
+
+			// Unprotect each page with pending writes once
+			std::vector<uint8_t*> touched;
+			for ( size_t i = 0; i < count; ++i ) {
+				Slot& slot = SlotAt ( static_cast< uint32_t >( i ) );
+				if ( !slot.live || !slot.dirty.load ( std::memory_order_relaxed ) ) continue;
+				uint8_t* page = PageOf ( slot.address );
+				if ( readOnly && std::find ( touched.begin ( ), touched.end ( ), page ) == touched.end ( ) ) {
+					Protect ( page, PAGE_READWRITE );
+					touched.push_back ( page );
+				}
+				Lock ( slot );
+				std::memcpy ( slot.address, slot.staged.data ( ), slot.size );
+				slot.dirty.store ( false, std::memory_order_relaxed );
+				SecureWipe ( slot.staged.data ( ), slot.size );
+				Unlock ( slot );
+				slot.digest = Digest ( slot.address, slot.size );
+			}
+			for ( uint8_t* page : touched ) {
+				Protect ( page, PAGE_READONLY );
+			}
+
+			detections += hits.size ( );
+			notify = handler;
+		}
+
+		for ( const auto& hit : hits ) {
+			SafeTamperLog::Instance ( ).Report ( SafeVarStatus::DecoyTampered, hit.first );
+			if ( notify ) notify ( hit.first, hit.second );
+		}
+		return hits.size ( );
+	}
+
+	size_t PageCount ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return pages.size ( );
+	}
+
+	uint64_t DetectionCount ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return detections;
+	}
+};
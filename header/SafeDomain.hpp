@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeDomain.hpp
+ * @brief   Isolated protection domains, one per match, with O(1) teardown.
+ *
+ * A SafeDomain bundles everything a match instance needs to protect its state:
+ *
+ *  - an arena: the SafeVar objects and their real memory come from the domain's own chunks,
+ *  - a key hierarchy: a master key, a keystream derived from it for every variable of the
+ *    domain, and DeriveKey() for further match-scoped keys (transport, journal),
+ *  - a registry of the variables created in it, for ValidateAll() and ReKeyAll(),
+ *  - a scheduler: tasks that Tick() runs every N ticks of the match.
+ *
+ * Close() retires the domain keystream first, so every value the domain encrypted becomes
+ * unreadable at once, and then hands the chunks back to the system. It runs no destructor and
+ * touches no variable; the cost depends on the number of chunks, not of variables. Decoys,
+ * state hashes, journals and histories live outside the domain: detach them (or Destroy() the
+ * variable) before closing. Pads are refused for domain variables (EnablePad() throws).
+ *
+ * Domain variables belong to the domain. Moves, swaps and copies with SafeVars outside the
+ * domain (or in another domain) re-encrypt the value under the receiving variable's keys and
+ * keep each variable's memory where it is, so nothing outside the domain dies with it.
+ *
+ * The master key comes from GenerateRandomBytes, so a SafeEntropy::Scope around construction
+ * makes a domain replay deterministically. Create, Destroy, Schedule, Tick and Close run on
+ * the match thread or under external synchronization with it.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+class SafeDomain
+{
+public:
+	static constexpr size_t OBJECT_CHUNK_SIZE = 64 * 1024;
+	static constexpr uint64_t KEYSTREAM_LABEL = 0;
+
+	using Task = std::function<void ( SafeDomain& )>;
+
+private:
+	using ValidateFn = SafeVarStatus ( * )( const void* var );
+	using ReKeyFn = void ( * )( void* var );
+	using DestroyFn = void ( * )( void* var );
+	using EmptyFn = bool ( * )( const void* var );
+
+	struct Entry
+	{
+		void* var;
+		EmptyFn empty;
+		ValidateFn validate;
+		ReKeyFn rekey;
+		DestroyFn destroy;
+	};
+
+	struct ScheduledTask
+	{
+		Task task;
+		uint32_t period;
+		uint32_t countdown;
+	};
+
+	std::array<uint8_t, 32> masterKey;
+	std::unique_ptr<SafeKeyDomain> keys;
+	SafeArena arena;
+	std::vector<uint8_t*> objectChunks;
+	size_t objectUsed = OBJECT_CHUNK_SIZE;      // bump offset within objectChunks.back()
+	std::vector<Entry> entries;
+	std::vector<ScheduledTask> tasks;
+	uint64_t ticks = 0;
+	bool closed = false;
+
+	// Moved-from variables hold no value until they are assigned again
+	template<typename T>
+	static bool Empty ( const void* var ) { return static_cast< const SafeVar<T>* >( var )->GetRealAddress ( ) == 0; }
+
+	template<typename T>
+	static SafeVarStatus Validate ( const void* var ) { return static_cast< const SafeVar<T>* >( var )->Validate ( ); }
+
+	template<typename T>
+	static void ReKey ( void* var ) { static_cast< SafeVar<T>* >( var )->ReKey ( ); }
+
+	template<typename T>
+	static void Destroy ( void* var ) { static_cast< SafeVar<T>* >( var )->~SafeVar ( ); }
+
+	void* AllocateObject ( size_t size, size_t align )
+	{
+		size_t offset = ( objectUsed + align - 1 ) & ~( align - 1 );
+		if ( objectChunks.empty ( ) || offset + size > OBJECT_CHUNK_SIZE ) {
+			objectChunks.push_back ( static_cast< uint8_t* >( RealMemoryAllocator::AllocateRealMemory ( OBJECT_CHUNK_SIZE ) ) );
+			offset = 0;
+		}
+		objectUsed = offset + size;
+		return objectChunks.back ( ) + offset;
+	}
+
+	void ThrowIfClosed ( ) const
+	{
+		if ( closed ) {
+			throw std::runtime_error ( "SafeDomain: domain is closed" );
+		}
+	}
+
+public:
+	SafeDomain ( )
+	{
+		GenerateRandomBytes ( masterKey.data ( ), masterKey.size ( ) );
+		uint64_t label = KEYSTREAM_LABEL;
+		uint8_t derived [ 64 ];
+		ChaCha20::KeystreamBlocks ( masterKey.data ( ), reinterpret_cast< const uint8_t* >( &label ), 0, derived, 1 );
+		keys.reset ( new SafeKeyDomain ( derived, derived + 32 ) );
+		SecureWipe ( derived, sizeof ( derived ) );
+	}
+
+	SafeDomain ( const SafeDomain& ) = delete;
+	SafeDomain& operator=( const SafeDomain& ) = delete;
+
+	~SafeDomain ( ) { Close ( ); }
+
+	// New variable in domain memory under the domain keystream; valid until Destroy() or Close()
+	template<typename T>
+	SafeVar<T>& Create ( const T& value = T { } )
+	{
+		static_assert( sizeof ( T ) <= SafeArena::MAX_SLOT_SIZE, "SafeDomain values must fit an arena slot." );
+		static_assert( sizeof ( SafeVar<T> ) <= OBJECT_CHUNK_SIZE, "SafeVar<T> exceeds a domain object chunk." );
+		ThrowIfClosed ( );
+
+		void* memory = AllocateObject ( sizeof ( SafeVar<T> ), alignof( SafeVar<T> ) );
+		SafeVar<T>* var = ::new ( memory ) SafeVar<T> ( arena, *keys, value );
+		entries.push_back ( { var, &Empty<T>, &Validate<T>, &ReKey<T>, &Destroy<T> } );
+		return *var;
+	}
+
+	// Run the variable's destructor now (detaching its attachments); its object slot is not reused
+	template<typename T>
+	void Destroy ( SafeVar<T>& var )
+	{
+		ThrowIfClosed ( );
+		for ( size_t i = 0; i < entries.size ( ); ++i ) {
+			if ( entries [ i ].var == &var ) {
+				entries [ i ].destroy ( entries [ i ].var );
+				entries [ i ] = entries.back ( );
+				entries.pop_back ( );
+				return;
+			}
+		}
+		throw std::runtime_error ( "SafeDomain: variable does not belong to this domain" );
+	}
+
+	// Match-scoped 32-byte key for label (anything but KEYSTREAM_LABEL); dies with the domain
+	void DeriveKey ( uint64_t label, uint8_t* out ) const
+	{
+		ThrowIfClosed ( );
+		if ( label == KEYSTREAM_LABEL ) {
+			throw std::runtime_error ( "SafeDomain: label is reserved for the domain keystream" );
+		}
+		uint8_t derived [ 64 ];
+		ChaCha20::KeystreamBlocks ( masterKey.data ( ), reinterpret_cast< const uint8_t* >( &label ), 0, derived, 1 );
+		std::memcpy ( out, derived, 32 );
+		SecureWipe ( derived, sizeof ( derived ) );
+	}
+
+	// Validate() every variable that holds a value; returns the number that failed
+	size_t ValidateAll ( ) const
+	{
+		size_t failures = 0;
+		for ( const Entry& entry : entries ) {
+			if ( entry.empty ( entry.var ) ) continue;
+			failures += entry.validate ( entry.var ) == SafeVarStatus::Ok ? 0 : 1;
+		}
+		return failures;
+	}
+
+	void ReKeyAll ( )
+	{
+		for ( const Entry& entry : entries ) {
+			if ( entry.empty ( entry.var ) ) continue;
+			entry.rekey ( entry.var );
+		}
+	}
+
+	// Run task on every periodTicks-th Tick(), starting with the periodTicks-th one from now
+	void Schedule ( Task task, uint32_t periodTicks )
+	{
+		ThrowIfClosed ( );
+		if ( periodTicks == 0 ) {
+			throw std::runtime_error ( "SafeDomain: task period must be at least one tick" );
+		}
+		tasks.push_back ( { std::move ( task ), periodTicks, periodTicks } );
+	}
+
+	// Advance the match clock by one tick and run the tasks that are due; returns how many ran
+	size_t Tick ( )
+	{
+		ThrowIfClosed ( );
+		++ticks;
+
+		// Tasks may schedule more tasks, so pick the due ones before running any
+		std::vector<size_t> due;
+		for ( size_t i = 0; i < tasks.size ( ); ++i ) {
+			if ( --tasks [ i ].countdown == 0 ) {
+				tasks [ i ].countdown = tasks [ i ].period;
+				due.push_back ( i );
+			}
+		}
+		for ( size_t i : due ) {
+			Task task = tasks [ i ].task;
+			task ( *this );
+			if ( closed ) break;
+		}
+		return due.size ( );
+	}
+
+	/**
+	 * Tear the domain down: retire its keystream, wipe the master key and release the arena and
+	 * object chunks. References to domain variables are dangling afterwards. Idempotent.
+	 */
+	void Close ( )
+	{
+		if ( closed ) return;
+		closed = true;
+
+		keys->Retire ( );
+		SecureWipe ( masterKey.data ( ), masterKey.size ( ) );
+		arena.Release ( );
+		for ( uint8_t* chunk : objectChunks ) {
+			RealMemoryAllocator::FreeRealMemory ( chunk );
+		}
+		objectChunks.clear ( );
+		objectUsed = OBJECT_CHUNK_SIZE;
+		entries.clear ( );
+		tasks.clear ( );
+	}
+
+	bool IsClosed ( ) const { return closed; }
+	size_t Size ( ) const { return entries.size ( ); }
+	uint64_t Ticks ( ) const { return ticks; }
+	SafeArena& Arena ( ) { return arena; }
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeHistory.hpp
+ * @brief   Encrypted per-variable value history with anomaly rules.
+ *
+ * SafeHistory<T, N> keeps the last N values written to an attached SafeVar<T> in a ring.
+ * Entries are XORed with a ChaCha20 keystream indexed by the write sequence, so each entry
+ * uses fresh keystream and one 64-byte block serves several consecutive small writes.
+ *
+ * SafeHistoryRules describe range, per-write delta and monotonicity limits. They can run on
+ * every write (comparing only against the previous value) or in batch over the whole ring,
+ * where the checks are branch-free loops over a contiguous scratch array that the compiler
+ * vectorizes.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+// Bitmask of violated rules
+enum SafeHistoryViolation : uint8_t
+{
+	SafeHistoryNone = 0,
+	SafeHistoryRange = 1 << 0,
+	SafeHistoryDelta = 1 << 1,
+	SafeHistoryMonotonic = 1 << 2
+};
+
+template<typename T>
+struct SafeHistoryRules
+{
+	bool checkRange = false;
+	T minValue { };
+	T maxValue { };
+
+	bool checkDelta = false;
+	T maxDelta { };        // largest allowed |value - previous| per write (negative: any change)
+
+	int monotonic = 0;     // +1 never decreases, -1 never increases, 0 unchecked
+};
+
+// Type of |a - b|: the unsigned counterpart for integers, so the difference cannot overflow
+template<typename T, bool = std::is_integral<T>::value && !std::is_same<T, bool>::value>
+struct SafeHistoryMagnitude { using type = T; };
+
+template<typename T>
+struct SafeHistoryMagnitude<T, true> { using type = typename std::make_unsigned<T>::type; };
+
+template<typename T, size_t N = 16>
+class SafeHistory : public SafeHistorySink<T>
+{
+	static_assert( std::is_arithmetic<T>::value, "SafeHistory<T> requires an arithmetic type." );
+	static_assert( N >= 2, "SafeHistory needs room for at least two values." );
+
+public:
+	// Runs on a write-time violation with the violation mask, the previous and the new value
+	using ViolationHandler = std::function<void ( uint8_t violations, T previous, T value )>;
+
+private:
+	static constexpr size_t VALUE_SIZE = sizeof ( T );
+
+	std::array<std::array<uint8_t, VALUE_SIZE>, N> ring;
+	uint64_t sequence = 0;                      // number of values recorded so far
+	std::array<uint8_t, 32> key;
+	uint8_t nonce [ 8 ];
+
+	mutable uint64_t cachedBlockIndex = ~0ULL;
+	mutable uint8_t cachedBlock [ 64 ];
+
+	SafeHistoryRules<T> rules;
+	bool checkOnWrite;
+	ViolationHandler handler;
+	uint32_t violationCount = 0;
+
+	// XOR the keystream bytes [offset, offset + len) into data
+	void ApplyKeystream ( uint64_t offset, uint8_t* data, size_t len ) const
+	{
+		for ( size_t i = 0; i < len; ++i, ++offset ) {
+			uint64_t blockIndex = offset / 64;
+			if ( blockIndex != cachedBlockIndex ) {
+				ChaCha20::KeystreamBlocks ( key.data ( ), nonce, blockIndex, cachedBlock, 1 );
+				cachedBlockIndex = blockIndex;
+			}
+			data [ i ] ^= cachedBlock [ offset % 64 ];
+		}
+	}
+
+	T Decrypt ( uint64_t seq ) const
+	{
+		std::array<uint8_t, VALUE_SIZE> bytes = ring [ seq % N ];
+		ApplyKeystream ( seq * VALUE_SIZE, bytes.data ( ), VALUE_SIZE );
+		T value;
+		std::memcpy ( &value, bytes.data ( ), VALUE_SIZE );
+		SecureWipe ( bytes.data ( ), VALUE_SIZE );
+		return value;
+	}
+
+	using Magnitude = typename SafeHistoryMagnitude<T>::type;
+
+	// Unsigned subtraction wraps, so for integers the result is exact even across the full range
+	static Magnitude Distance ( T a, T b )
+	{
+		return a > b ? static_cast< Magnitude >( static_cast< Magnitude >( a ) - static_cast< Magnitude >( b ) )
+			: static_cast< Magnitude >( static_cast< Magnitude >( b ) - static_cast< Magnitude >( a ) );
+	}
+
+	static Magnitude DeltaLimit ( T maxDelta ) { return maxDelta > T { } ? static_cast< Magnitude >( maxDelta ) : Magnitude { }; }
+
+	// Rule check for one transition; also used by the batch path
+	static uint8_t CheckStep ( const SafeHistoryRules<T>& r, T previous, T value )
+	{
+		uint8_t violations = SafeHistoryNone;
+		if ( r.checkRange && ( value < r.minValue || value > r.maxValue ) ) violations |= SafeHistoryRange;
+		if ( r.checkDelta && Distance ( previous, value ) > DeltaLimit ( r.maxDelta ) ) violations |= SafeHistoryDelta;
+		if ( ( r.monotonic > 0 && value < previous ) || ( r.monotonic < 0 && value > previous ) ) violations |= SafeHistoryMonotonic;
+		return violations;
+	}
+
+public:
+	explicit SafeHistory ( const SafeHistoryRules<T>& historyRules = SafeHistoryRules<T> ( ), bool checkEveryWrite = true )
+		: rules ( historyRules ), checkOnWrite ( checkEveryWrite )
+	{
+		GenerateRandomBytes ( key.data ( ), key.size ( ) );
+		GenerateRandomBytes ( nonce, sizeof ( nonce ) );
+		for ( auto& entry : ring ) entry.fill ( 0 );
+	}
+
+	SafeHistory ( const SafeHistory& ) = delete;
+	SafeHistory& operator=( const SafeHistory& ) = delete;
+
+	~SafeHistory ( )
+	{
+		SecureWipe ( key.data ( ), key.size ( ) );
+		SecureWipe ( cachedBlock, sizeof ( cachedBlock ) );
+	}
+
+	void Record ( const T& value ) override
+	{
+		if ( checkOnWrite && sequence > 0 ) {
+			T previous = Decrypt ( sequence - 1 );
+			uint8_t violations = CheckStep ( rules, previous, value );
+			if ( violations != SafeHistoryNone ) {
+				++violationCount;
+				if ( handler ) handler ( violations, previous, value );
+			}
+			SecureWipe ( &previous, VALUE_SIZE );
+		}
+
+		std::array<uint8_t, VALUE_SIZE>& entry = ring [ sequence % N ];
+		std::memcpy ( entry.data ( ), &value, VALUE_SIZE );
+		ApplyKeystream ( sequence * VALUE_SIZE, entry.data ( ), VALUE_SIZE );
+		++sequence;
+	}
+
+	void SetRules ( const SafeHistoryRules<T>& historyRules ) { rules = historyRules; }
+	void SetViolationHandler ( ViolationHandler violationHandler ) { handler = std::move ( violationHandler ); }
+	uint32_t ViolationCount ( ) const { return violationCount; }
+
+	size_t Size ( ) const { return static_cast< size_t >( sequence < N ? sequence : N ); }
+	uint64_t TotalRecorded ( ) const { return sequence; }
+
+	// Decrypt the ring oldest-first into out (room for N values); returns the number written
+	size_t Snapshot ( T* out ) const
+	{
+		size_t count = Size ( );
+		uint64_t first = sequence - count;
+		for ( size_t i = 0; i < count; ++i ) {
+			out [ i ] = Decrypt ( first + i );
+		}
+		return count;
+	}
+
+	// Batch evaluation over the whole ring; returns the union of violated rules
+	uint8_t Evaluate ( const SafeHistoryRules<T>& r ) const
+	{
+		T values [ N ];
+		size_t count = Snapshot ( values );
+		uint8_t result = SafeHistoryNone;
+
+		if ( r.checkRange ) {
+			bool outside = false;
+			for ( size_t i = 0; i < count; ++i ) {
+				outside |= ( values [ i ] < r.minValue ) | ( values [ i ] > r.maxValue );
+			}
+			if ( outside ) result |= SafeHistoryRange;
+		}
+
+		if ( r.checkDelta ) {
+			bool jump = false;
+			Magnitude limit = DeltaLimit ( r.maxDelta );
+			for ( size_t i = 1; i < count; ++i ) {
+				jump |= Distance ( values [ i - 1 ], values [ i ] ) > limit;
+			}
+			if ( jump ) result |= SafeHistoryDelta;
+		}
+
+		if ( r.monotonic != 0 ) {
+			bool decreased = false, increased = false;
+			for ( size_t i = 1; i < count; ++i ) {
+				decreased |= values [ i ] < values [ i - 1 ];
+				increased |= values [ i ] > values [ i - 1 ];
+			}
+			if ( ( r.monotonic > 0 && decreased ) || ( r.monotonic < 0 && increased ) ) result |= SafeHistoryMonotonic;
+		}
+
+		SecureWipe ( values, sizeof ( values ) );
+		return result;
+	}
+
+	uint8_t Evaluate ( ) const { return Evaluate ( rules ); }
+
+	// Evaluate many histories with one rule set; results[i] receives the mask of histories[i]
+	static size_t EvaluateBatch ( const SafeHistory* const* histories, size_t count, const SafeHistoryRules<T>& r, uint8_t* results )
+	{
+		size_t flagged = 0;
+		for ( size_t i = 0; i < count; ++i ) {
+			results [ i ] = histories [ i ]->Evaluate ( r );
+			flagged += results [ i ] != SafeHistoryNone ? 1 : 0;
+		}
+		return flagged;
+	}
+};
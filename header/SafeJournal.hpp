@@ -0,0 +1,473 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeJournal.hpp
+ * @brief   Append-only, tamper-evident journal of SafeVar writes.
+ *
+ * Attached variables report every Set() as (id, generation, ciphertext + keystream mask). The hot
+ * path copies that record into a buffer owned by the calling thread. A background thread
+ * drains all thread buffers into a batch, encrypts the batch under the journal key, chains
+ * it to the previous batch with a SipHash tag and appends it to the journal file. Removing,
+ * reordering or editing a batch breaks the chain, which SafeJournal::ReadFile() reports.
+ *
+ * File layout: "SVJ3" magic and a random 8-byte file salt, then frames of
+ *   [sequence u64][length u32][record count u32][ciphertext: length bytes][chain tag u64]
+ * and, written when the journal is destroyed, a terminator
+ *   [END_SEQUENCE u64][batch count u64][chain tag u64]
+ *
+ * Batches are encrypted under a file key derived from the journal key and the salt, with the
+ * sequence number as nonce, so no two batches share keystream within a file or across files
+ * written under the same journal key. The salt also seeds the chain, so batches cannot be
+ * spliced in from another file. Cutting off trailing batches drops the terminator, and
+ * ReadFile() then fails.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+// One decoded journal entry
+struct SafeJournalRecord
+{
+	uint64_t id = 0;
+	uint64_t generation = 0;
+	std::vector<uint8_t> value;
+};
+
+class SafeJournal : public SafeJournalSink
+{
+public:
+	static constexpr size_t MAX_VALUE_SIZE = 256;
+
+private:
+	static constexpr uint32_t FILE_MAGIC = 0x334A5653;  // "SVJ3"
+	static constexpr uint64_t END_SEQUENCE = ~0ULL;
+	static constexpr size_t SALT_SIZE = 8;
+
+	// Followed by valueLen mask bytes and valueLen ciphertext bytes
+	struct RecordHeader
+	{
+		uint64_t id;
+		uint64_t generation;
+		uint32_t valueLen;
+		uint32_t reserved;
+	};
+
+	struct ThreadBuffer
+	{
+		std::mutex mtx;
+		std::vector<uint8_t> data;
+		uint32_t records = 0;
+	};
+
+	// This thread's buffer in every journal it appended to, keyed by journal serial. Serials are
+	// never reused, so a new journal at the address of a destroyed one cannot pick up its buffer.
+	using ThreadCache = std::unordered_map<uint64_t, ThreadBuffer*>;
+
+	std::array<uint8_t, 32> encryptionKey;  // file key, derived from the journal key and salt
+	std::array<uint8_t, 16> macKey;
+	std::ofstream file;
+	std::array<uint8_t, SALT_SIZE> salt;
+	uint64_t serial;
+	uint64_t sequence = 0;
+	uint64_t chainTag = 0;
+	size_t bufferThreshold;
+	std::chrono::milliseconds flushInterval;
+
+	std::mutex buffersMtx;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	std::mutex flushMtx;
+	std::mutex wakeMtx;
+	std::condition_variable wake;
+	bool stopping = false;
+	bool flushRequested = false;
+	std::thread worker;
+
+	static uint64_t NextSerial ( )
+	{
+		static std::atomic<uint64_t> counter { 0 };
+		return ++counter;
+	}
+
+	static ThreadCache& LocalCache ( )
+	{
+		static thread_local ThreadCache cache;
+		return cache;
+	}
+
+	// Serials of the journals that are still alive
+	static std::mutex& LiveMutex ( )
+	{
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	static std::unordered_set<uint64_t>& LiveSerials ( )
+	{
+		static std::unordered_set<uint64_t> serials;
+		return serials;
+	}
+
+	// Each (thread, journal) pair allocates its buffer once. A miss also drops the cache
+	// entries of destroyed journals, so the per-thread map stays as small as the live set.
+	ThreadBuffer& LocalBuffer ( )
+	{
+		ThreadCache& cache = LocalCache ( );
+		auto found = cache.find ( serial );
+		if ( found != cache.end ( ) ) {
+			return *found->second;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock ( LiveMutex ( ) );
+			const std::unordered_set<uint64_t>& live = LiveSerials ( );
+			for ( auto it = cache.begin ( ); it != cache.end ( ); ) {
+				if ( live.count ( it->first ) ) ++it;
+				else it = cache.erase ( it );
+			}
+		}
+
+		std::lock_guard<std::mutex> lock ( buffersMtx );
+		buffers.emplace_back ( new ThreadBuffer ( ) );
+		buffers.back ( )->data.reserve ( bufferThreshold * 2 );
+		ThreadBuffer* buffer = buffers.back ( ).get ( );
+		cache [ serial ] = buffer;
+		return *buffer;
+	}
+
+	static uint64_t ChainTag ( const uint8_t* macKey16, uint64_t previous, uint64_t seq, const uint8_t* cipher, size_t len )
+	{
+		uint8_t message [ 24 ];
+		uint64_t body = ComputeSipHash ( macKey16, cipher, len );
+		std::memcpy ( message, &previous, 8 );
+		std::memcpy ( message + 8, &seq, 8 );
+		std::memcpy ( message + 16, &body, 8 );
+		return ComputeSipHash ( macKey16, message, sizeof ( message ) );
+	}
+
+	// Chain value before the first batch, bound to the file salt
+	static uint64_t ChainSeed ( const uint8_t* macKey16, const uint8_t* fileSalt )
+	{
+		uint8_t message [ 4 + SALT_SIZE ];
+		uint32_t magic = FILE_MAGIC;
+		std::memcpy ( message, &magic, 4 );
+		std::memcpy ( message + 4, fileSalt, SALT_SIZE );
+		return ComputeSipHash ( macKey16, message, sizeof ( message ) );
+	}
+
+	// Closes the chain over the number of batches, so a cut-off file cannot end cleanly
+	static uint64_t EndTag ( const uint8_t* macKey16, uint64_t previous, uint64_t batches )
+	{
+		uint8_t message [ 24 ];
+		uint64_t marker = END_SEQUENCE;
+		std::memcpy ( message, &previous, 8 );
+		std::memcpy ( message + 8, &marker, 8 );
+		std::memcpy ( message + 16, &batches, 8 );
+		return ComputeSipHash ( macKey16, message, sizeof ( message ) );
+	}
+
+	// File key: the first half of the journal key's keystream block under the salt
+	static void DeriveFileKey ( const uint8_t* journalKey32, const uint8_t* fileSalt, uint8_t* fileKey32 )
+	{
+		uint8_t block [ 64 ];
+		ChaCha20::KeystreamBlocks ( journalKey32, fileSalt, 0, block, 1 );
+		std::memcpy ( fileKey32, block, 32 );
+		SecureWipe ( block, sizeof ( block ) );
+	}
+
+	// ChaCha20::Encrypt reads the first 8 nonce bytes, so the sequence goes there
+	static void BatchNonce ( uint64_t seq, uint8_t* nonce12 )
+	{
+		std::memset ( nonce12, 0, 12 );
+		std::memcpy ( nonce12, &seq, 8 );
+	}
+
+	// Drains every thread buffer, seals the batch and appends it to the file
+	void DrainAndWrite ( )
+	{
+		std::lock_guard<std::mutex> flushLock ( flushMtx );
+
+		// Take the buffers first and size the batch once, so it never reallocates over plaintext
+		std::vector<std::vector<uint8_t>> drained;
+		size_t total = 0;
+		uint32_t count = 0;
+		{
+			std::lock_guard<std::mutex> lock ( buffersMtx );
+			for ( auto& buffer : buffers ) {
+				std::lock_guard<std::mutex> bufferLock ( buffer->mtx );
+				if ( buffer->data.empty ( ) ) continue;
+				drained.emplace_back ( );
+				drained.back ( ).swap ( buffer->data );
+				buffer->data.reserve ( bufferThreshold * 2 );
+				total += drained.back ( ).size ( );
+				count += buffer->records;
+				buffer->records = 0;
+			}
+		}
+
+		if ( total == 0 ) return;
+
+		std::vector<uint8_t> batch;
+		batch.reserve ( total );
+		for ( auto& data : drained ) {
+			batch.insert ( batch.end ( ), data.begin ( ), data.end ( ) );
+			SecureWipe ( data.data ( ), data.size ( ) );
+		}
+
+		++sequence;
+		std::vector<uint8_t> sealed ( batch.size ( ) );
+		uint8_t nonce [ 12 ];
+		BatchNonce ( sequence, nonce );
+		ChaCha20::Encrypt ( batch.data ( ), sealed.data ( ), batch.size ( ), encryptionKey.data ( ), nonce );
+		SecureWipe ( batch.data ( ), batch.size ( ) );
+
+		chainTag = ChainTag ( macKey.data ( ), chainTag, sequence, sealed.data ( ), sealed.size ( ) );
+
+		uint32_t length = static_cast< uint32_t >( sealed.size ( ) );
+		file.write ( reinterpret_cast< const char* >( &sequence ), 8 );
+		file.write ( reinterpret_cast< const char* >( &length ), 4 );
+		file.write ( reinterpret_cast< const char* >( &count ), 4 );
+		file.write ( reinterpret_cast< const char* >( sealed.data ( ) ), sealed.size ( ) );
+		file.write ( reinterpret_cast< const char* >( &chainTag ), 8 );
+		file.flush ( );
+	}
+
+	void WorkerLoop ( )
+	{
+		std::unique_lock<std::mutex> lock ( wakeMtx );
+		while ( !stopping ) {
+			wake.wait_for ( lock, flushInterval, [ this ] { return stopping || flushRequested; } );
+			flushRequested = false;
+
+			lock.unlock ( );
+			DrainAndWrite ( );
+			lock.lock ( );
+		}
+	}
+
+public:
+	/**
+	 * @param path             journal file, created or truncated
+	 * @param journalKey       encryption key for the file (held by the auditor)
+	 * @param chainKey         SipHash key for the batch chain (held by the auditor)
+	 * @param flushEvery       background flush interval
+	 * @param thresholdBytes   per-thread buffer size that triggers an early flush
+	 */
+	SafeJournal ( const std::string& path, const std::array<uint8_t, 32>& journalKey, const std::array<uint8_t, 16>& chainKey,
+		std::chrono::milliseconds flushEvery = std::chrono::milliseconds ( 250 ), size_t thresholdBytes = 1 << 20 )
+		: encryptionKey ( journalKey ), macKey ( chainKey ), file ( path, std::ios::binary | std::ios::trunc ),
+		serial ( NextSerial ( ) ), bufferThreshold ( thresholdBytes ), flushInterval ( flushEvery )
+	{
+		if ( !file ) {
+			throw std::runtime_error ( "SafeJournal: cannot open journal file" );
+		}
+		GenerateRandomBytes ( salt.data ( ), salt.size ( ) );
+		DeriveFileKey ( journalKey.data ( ), salt.data ( ), encryptionKey.data ( ) );
+		chainTag = ChainSeed ( macKey.data ( ), salt.data ( ) );
+		{
+			std::lock_guard<std::mutex> lock ( LiveMutex ( ) );
+			LiveSerials ( ).insert ( serial );
+		}
+
+		uint32_t magic = FILE_MAGIC;
+		file.write ( reinterpret_cast< const char* >( &magic ), 4 );
+		file.write ( reinterpret_cast< const char* >( salt.data ( ) ), salt.size ( ) );
+		worker = std::thread ( &SafeJournal::WorkerLoop, this );
+	}
+
+	SafeJournal ( const SafeJournal& ) = delete;
+	SafeJournal& operator=( const SafeJournal& ) = delete;
+
+	~SafeJournal ( )
+	{
+		{
+			std::lock_guard<std::mutex> lock ( wakeMtx );
+			stopping = true;
+		}
+		wake.notify_one ( );
+		worker.join ( );
+		DrainAndWrite ( );
+
+		uint64_t marker = END_SEQUENCE;
+		uint64_t endTag = EndTag ( macKey.data ( ), chainTag, sequence );
+		file.write ( reinterpret_cast< const char* >( &marker ), 8 );
+		file.write ( reinterpret_cast< const char* >( &sequence ), 8 );
+		file.write ( reinterpret_cast< const char* >( &endTag ), 8 );
+		file.flush ( );
+
+		SecureWipe ( encryptionKey.data ( ), encryptionKey.size ( ) );
+		SecureWipe ( macKey.data ( ), macKey.size ( ) );
+
+		std::lock_guard<std::mutex> lock ( LiveMutex ( ) );
+		LiveSerials ( ).erase ( serial );
+	}
+
+	size_t MaxValueSize ( ) const override { return MAX_VALUE_SIZE; }
+
+	// Hot path: one bounded copy into the calling thread's buffer. Never throws for oversized
+	// values: SafeVar::AttachJournal already rejects types larger than MAX_VALUE_SIZE.
+	void Append ( uint64_t id, uint64_t generation, const uint8_t* mask, const uint8_t* cipher, size_t len ) override
+	{
+		if ( len > MAX_VALUE_SIZE ) return;
+
+		RecordHeader header;
+		header.id = id;
+		header.generation = generation;
+		header.valueLen = static_cast< uint32_t >( len );
+		header.reserved = 0;
+
+		ThreadBuffer& buffer = LocalBuffer ( );
+		bool full;
+		{
+			std::lock_guard<std::mutex> lock ( buffer.mtx );
+			size_t offset = buffer.data.size ( );
+			size_t needed = offset + sizeof ( header ) + 2 * len;
+			if ( needed > buffer.data.capacity ( ) ) {
+				// Grow by hand so the old allocation is wiped instead of freed with records in it
+				std::vector<uint8_t> grown;
+				grown.reserve ( needed * 2 );
+				grown.assign ( buffer.data.begin ( ), buffer.data.end ( ) );
+				SecureWipe ( buffer.data.data ( ), buffer.data.size ( ) );
+				buffer.data.swap ( grown );
+			}
+			buffer.data.resize ( needed );
+			uint8_t* dst = buffer.data.data ( ) + offset;
+			std::memcpy ( dst, &header, sizeof ( header ) );
+			std::memcpy ( dst + sizeof ( header ), mask, len );
+			std::memcpy ( dst + sizeof ( header ) + len, cipher, len );
+			++buffer.records;
+			full = buffer.data.size ( ) >= bufferThreshold;
+		}
+
+		if ( full ) {
+			{
+				std::lock_guard<std::mutex> lock ( wakeMtx );
+				flushRequested = true;
+			}
+			wake.notify_one ( );
+		}
+	}
+
+	// Synchronously seal and write everything appended so far
+	void Flush ( )
+	{
+		DrainAndWrite ( );
+	}
+
+	uint64_t BatchCount ( ) const { return sequence; }
+
+	/**
+	 * Verify the chain of a journal file and decode its records in order.
+	 * Returns true only for a complete file: every batch passes the chain check and the file
+	 * ends with a valid terminator. Otherwise returns false (truncated file, missing terminator
+	 * after a crash, failed batch); records of batches before the failure have been delivered.
+	 */
+	static bool ReadFile ( const std::string& path, const std::array<uint8_t, 32>& journalKey, const std::array<uint8_t, 16>& chainKey,
+		const std::function<void ( const SafeJournalRecord& )>& visitor )
+	{
+		std::ifstream in ( path, std::ios::binary );
+		uint32_t magic = 0;
+		if ( !in.read ( reinterpret_cast< char* >( &magic ), 4 ) || magic != FILE_MAGIC ) return false;
+		uint8_t fileSalt [ SALT_SIZE ];
+		if ( !in.read ( reinterpret_cast< char* >( fileSalt ), SALT_SIZE ) ) return false;
+
+		std::streamoff dataStart = in.tellg ( );
+		in.seekg ( 0, std::ios::end );
+		std::streamoff fileEnd = in.tellg ( );
+		in.seekg ( dataStart );
+		if ( dataStart < 0 || fileEnd < dataStart || !in ) return false;
+
+		std::array<uint8_t, 32> fileKey;
+		DeriveFileKey ( journalKey.data ( ), fileSalt, fileKey.data ( ) );
+		struct KeyWipe
+		{
+			std::array<uint8_t, 32>& key;
+			~KeyWipe ( ) { SecureWipe ( key.data ( ), key.size ( ) ); }
+		} keyWipe { fileKey };
+
+		uint64_t previous = ChainSeed ( chainKey.data ( ), fileSalt );
+		uint64_t expectedSeq = 1;
+		for ( ;; ) {
+			uint64_t seq;
+			uint32_t length, count;
+			if ( !in.read ( reinterpret_cast< char* >( &seq ), 8 ) ) return false;
+
+			if ( seq == END_SEQUENCE ) {
+				uint64_t batches, tag;
+				if ( !in.read ( reinterpret_cast< char* >( &batches ), 8 ) ) return false;
+				if ( !in.read ( reinterpret_cast< char* >( &tag ), 8 ) ) return false;
+				if ( batches != expectedSeq - 1 || EndTag ( chainKey.data ( ), previous, batches ) != tag ) return false;
+				return in.peek ( ) == std::char_traits<char>::eof ( );
+			}
+
+			if ( !in.read ( reinterpret_cast< char* >( &length ), 4 ) ) return false;
+			if ( !in.read ( reinterpret_cast< char* >( &count ), 4 ) ) return false;
+
+			// The length is untrusted: it must fit in what is left of the file, before the tag
+			std::streamoff remaining = fileEnd - in.tellg ( );
+			if ( remaining < 8 || static_cast< uint64_t >( length ) > static_cast< uint64_t >( remaining - 8 ) ) return false;
+
+			std::vector<uint8_t> sealed ( length );
+			uint64_t tag;
+			if ( !in.read ( reinterpret_cast< char* >( sealed.data ( ) ), length ) ) return false;
+			if ( !in.read ( reinterpret_cast< char* >( &tag ), 8 ) ) return false;
+
+			if ( seq != expectedSeq || ChainTag ( chainKey.data ( ), previous, seq, sealed.data ( ), sealed.size ( ) ) != tag ) {
+				return false;
+			}
+			previous = tag;
+			++expectedSeq;
+
+			std::vector<uint8_t> batch ( length );
+			uint8_t nonce [ 12 ];
+			BatchNonce ( seq, nonce );
+			ChaCha20::Encrypt ( sealed.data ( ), batch.data ( ), length, fileKey.data ( ), nonce );
+
+			size_t offset = 0;
+			for ( uint32_t i = 0; i < count; ++i ) {
+				RecordHeader header;
+				if ( offset + sizeof ( header ) > batch.size ( ) ) return false;
+				std::memcpy ( &header, batch.data ( ) + offset, sizeof ( header ) );
+				if ( header.valueLen > MAX_VALUE_SIZE ) return false;
+				size_t recordSize = sizeof ( header ) + 2 * static_cast< size_t >( header.valueLen );
+				if ( offset + recordSize > batch.size ( ) ) return false;
+
+				const uint8_t* mask = batch.data ( ) + offset + sizeof ( header );
+				const uint8_t* cipher = mask + header.valueLen;
+
+				SafeJournalRecord record;
+				record.id = header.id;
+				record.generation = header.generation;
+				record.value.resize ( header.valueLen );
+				for ( uint32_t b = 0; b < header.valueLen; ++b ) {
+					record.value [ b ] = cipher [ b ] ^ mask [ b ];
+				}
+
+				visitor ( record );
+				SecureWipe ( record.value.data ( ), record.value.size ( ) );
+				offset += recordSize;
+			}
+			SecureWipe ( batch.data ( ), batch.size ( ) );
+		}
+	}
+};
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeLeaderboard.hpp
+ * @brief   Protected leaderboard with incremental rank and top-K queries.
+ *
+ * Every score is stored in its own SafeVar. Ordering uses a secondary key produced by a keyed
+ * order-preserving encoding: a random strictly increasing map from the 32-bit score domain
+ * into 63 bits, drawn by splitting the range at SipHash-chosen points, one per bit of the
+ * score. The gaps between neighbouring keys are random, so keys reveal the order of scores but
+ * not their values or differences, and they cannot be decoded without the key.
+ *
+ * Keys live in an order-statistics treap. Comparisons, rank lookups and re-ordering never
+ * decrypt anything; a score change costs one decryption of the encoding key, 32 SipHash calls
+ * and one SafeVar write, and the treap update is O(log n). AtRank() and TopK() report the
+ * score held in the entry's SafeVar and check it against the ordering key. Highest score ranks
+ * first, ties rank the lower id first.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+template<typename Score>
+struct SafeLeaderboardEntry
+{
+	uint64_t id;
+	Score score;
+	size_t rank;
+};
+
+template<typename Score = int32_t>
+class SafeLeaderboard
+{
+	static_assert( std::is_integral<Score>::value && sizeof ( Score ) <= 4,
+		"SafeLeaderboard scores must be integral types of at most 32 bits." );
+
+private:
+	using OrderKey = std::array<uint8_t, 16>;
+
+	static constexpr unsigned DOMAIN_BITS = 32;
+
+	struct Node
+	{
+		uint64_t orderKey;
+		uint64_t id;
+		uint32_t priority;
+		size_t size = 1;
+		Node* left = nullptr;
+		Node* right = nullptr;
+		SafeVar<Score> score;
+	};
+
+	std::unordered_map<uint64_t, std::unique_ptr<Node>> nodes;
+	Node* root = nullptr;
+	SafeVar<OrderKey> encodingKey;
+	std::mt19937 priorities;
+
+	static uint64_t Bias ( Score score )
+	{
+		return static_cast< uint64_t >( static_cast< int64_t >( score ) - static_cast< int64_t >( std::numeric_limits<Score>::min ( ) ) );
+	}
+
+	/**
+	 * Keyed order-preserving encoding. Walks the score's bits from the top; at each level the
+	 * current range is cut in two at a point chosen by SipHash over (level, bits so far), leaving
+	 * at least one range value for every score on each side. The result is strictly increasing
+	 * in the score and depends on the key at every level.
+	 */
+	static uint64_t Encode ( const OrderKey& key, Score score )
+	{
+		uint64_t biased = Bias ( score );
+		uint64_t rangeLow = 0;
+		uint64_t rangeSize = 1ULL << 63;
+		for ( unsigned level = 0; level < DOMAIN_BITS; ++level ) {
+			uint64_t half = 1ULL << ( DOMAIN_BITS - 1 - level );
+			uint64_t message [ 2 ] = { level, biased >> ( DOMAIN_BITS - level ) };
+			uint64_t slack = rangeSize - 2 * half;
+			uint64_t split = half + ComputeSipHash ( key.data ( ), reinterpret_cast< const uint8_t* >( message ), sizeof ( message ) ) % ( slack + 1 );
+			if ( ( biased >> ( DOMAIN_BITS - 1 - level ) ) & 1 ) {
+				rangeLow += split;
+				rangeSize -= split;
+			}
+			else {
+				rangeSize = split;
+			}
+		}
+		return rangeLow;
+	}
+
+	// Leaderboard order: higher score first, then lower id
+	static bool Before ( uint64_t keyA, uint64_t idA, uint64_t keyB, uint64_t idB )
+	{
+		return keyA != keyB ? keyA > keyB : idA < idB;
+	}
+
+	static bool Before ( const Node* a, const Node* b ) { return Before ( a->orderKey, a->id, b->orderKey, b->id ); }
+
+	static size_t SizeOf ( const Node* t ) { return t ? t->size : 0; }
+	static void Update ( Node* t ) { t->size = 1 + SizeOf ( t->left ) + SizeOf ( t->right ); }
+
+	static Node* Merge ( Node* a, Node* b )
+	{
+		if ( !a ) return b;
+		if ( !b ) return a;
+		if ( a->priority > b->priority ) {
+			a->right = Merge ( a->right, b );
+			Update ( a );
+			return a;
+		}
+		b->left = Merge ( a, b->left );
+		Update ( b );
+		return b;
+	}
+
+	// Splits t into nodes ordered before key and the rest
+	static void Split ( Node* t, const Node* key, Node*& before, Node*& rest )
+	{
+		if ( !t ) {
+			before = rest = nullptr;
+			return;
+		}
+		if ( Before ( t, key ) ) {
+			Split ( t->right, key, t->right, rest );
+			before = t;
+		}
+		else {
+			Split ( t->left, key, before, t->left );
+			rest = t;
+		}
+		Update ( t );
+	}
+
+	static Node* Erase ( Node* t, const Node* key )
+	{
+		if ( t == key ) {
+			return Merge ( t->left, t->right );
+		}
+		if ( Before ( key, t ) ) t->left = Erase ( t->left, key );
+		else t->right = Erase ( t->right, key );
+		Update ( t );
+		return t;
+	}
+
+	void Insert ( Node* node )
+	{
+		node->left = node->right = nullptr;
+		node->size = 1;
+		Node* before;
+		Node* rest;
+		Split ( root, node, before, rest );
+		root = Merge ( Merge ( before, node ), rest );
+	}
+
+	const Node* AtIndex ( size_t index ) const
+	{
+		const Node* t = root;
+		while ( t ) {
+			size_t leftSize = SizeOf ( t->left );
+			if ( index < leftSize ) t = t->left;
+			else if ( index == leftSize ) return t;
+			else {
+				index -= leftSize + 1;
+				t = t->right;
+			}
+		}
+		return nullptr;
+	}
+
+	template<typename Fn>
+	static void InOrder ( const Node* t, size_t& remaining, Fn& visit )
+	{
+		if ( !t || remaining == 0 ) return;
+		InOrder ( t->left, remaining, visit );
+		if ( remaining == 0 ) return;
+		visit ( t );
+		--remaining;
+		InOrder ( t->right, remaining, visit );
+	}
+
+	static OrderKey GenerateKey ( )
+	{
+		OrderKey key;
+		GenerateRandomBytes ( key.data ( ), key.size ( ) );
+		return key;
+	}
+
+	// Authoritative score of a node, checked against its ordering key
+	static Score CheckedScore ( const OrderKey& key, const Node* node )
+	{
+		Score score = node->score.Get ( );
+		if ( Encode ( key, score ) != node->orderKey ) {
+			throw std::runtime_error ( "SafeLeaderboard: ordering key does not match the stored score" );
+		}
+		return score;
+	}
+
+public:
+	SafeLeaderboard ( ) : encodingKey ( GenerateKey ( ) )
+	{
+		uint32_t seed;
+		GenerateRandomBytes ( reinterpret_cast< uint8_t* >( &seed ), sizeof ( seed ) );
+		priorities.seed ( seed );
+	}
+
+	SafeLeaderboard ( const SafeLeaderboard& ) = delete;
+	SafeLeaderboard& operator=( const SafeLeaderboard& ) = delete;
+
+	// Insert or update a score: O(log n), one decryption
+	void Set ( uint64_t id, Score score )
+	{
+		OrderKey key = encodingKey.Get ( );
+		uint64_t orderKey = Encode ( key, score );
+		SecureWipe ( key.data ( ), key.size ( ) );
+
+		auto it = nodes.find ( id );
+		if ( it == nodes.end ( ) ) {
+			std::unique_ptr<Node> node ( new Node ( ) );
+			node->id = id;
+			node->priority = priorities ( );
+			node->orderKey = orderKey;
+			node->score.Set ( score );
+			Insert ( node.get ( ) );
+			nodes.emplace ( id, std::move ( node ) );
+			return;
+		}
+
+		Node* node = it->second.get ( );
+		node->score.Set ( score );
+		if ( node->orderKey != orderKey ) {
+			root = Erase ( root, node );
+			node->orderKey = orderKey;
+			Insert ( node );
+		}
+	}
+
+	bool Remove ( uint64_t id )
+	{
+		auto it = nodes.find ( id );
+		if ( it == nodes.end ( ) ) return false;
+		root = Erase ( root, it->second.get ( ) );
+		nodes.erase ( it );
+		return true;
+	}
+
+	bool Contains ( uint64_t id ) const { return nodes.count ( id ) != 0; }
+	size_t Size ( ) const { return nodes.size ( ); }
+
+	// Authoritative score of an entry (full SafeVar verification)
+	Score Get ( uint64_t id ) const
+	{
+		auto it = nodes.find ( id );
+		if ( it == nodes.end ( ) ) throw std::out_of_range ( "SafeLeaderboard: unknown id" );
+		return it->second->score.Get ( );
+	}
+
+	// 1-based rank, 0 if the id is not on the board. No decryption.
+	size_t Rank ( uint64_t id ) const
+	{
+		auto it = nodes.find ( id );
+		if ( it == nodes.end ( ) ) return 0;
+
+		const Node* target = it->second.get ( );
+		const Node* t = root;
+		size_t rank = 0;
+		while ( t ) {
+			if ( t == target ) return rank + SizeOf ( t->left ) + 1;
+			if ( Before ( target, t ) ) {
+				t = t->left;
+			}
+			else {
+				rank += SizeOf ( t->left ) + 1;
+				t = t->right;
+			}
+		}
+		return 0;
+	}
+
+	// Entry at a 1-based rank. The score comes from the entry's SafeVar; throws if it no longer
+	// matches the ordering key.
+	bool AtRank ( size_t rank, SafeLeaderboardEntry<Score>& out ) const
+	{
+		if ( rank == 0 ) return false;
+		const Node* node = AtIndex ( rank - 1 );
+		if ( !node ) return false;
+
+		OrderKey key = encodingKey.Get ( );
+		try {
+			out.score = CheckedScore ( key, node );
+		}
+		catch ( ... ) {
+			SecureWipe ( key.data ( ), key.size ( ) );
+			throw;
+		}
+		SecureWipe ( key.data ( ), key.size ( ) );
+		out.id = node->id;
+		out.rank = rank;
+		return true;
+	}
+
+	// Best k entries in rank order, scores from their SafeVars and checked like AtRank()
+	std::vector<SafeLeaderboardEntry<Score>> TopK ( size_t k ) const
+	{
+		std::vector<SafeLeaderboardEntry<Score>> result;
+		result.reserve ( std::min ( k, nodes.size ( ) ) );
+
+		OrderKey key = encodingKey.Get ( );
+		auto visit = [ & ] ( const Node* node ) {
+			result.push_back ( { node->id, CheckedScore ( key, node ), result.size ( ) + 1 } );
+		};
+		size_t remaining = k;
+		try {
+			InOrder ( root, remaining, visit );
+		}
+		catch ( ... ) {
+			SecureWipe ( key.data ( ), key.size ( ) );
+			throw;
+		}
+		SecureWipe ( key.data ( ), key.size ( ) );
+		return result;
+	}
+
+	// Full O(n) cross-check of every ordering key against its SafeVar; false on any mismatch
+	bool Verify ( ) const
+	{
+		OrderKey key = encodingKey.Get ( );
+		bool ok = true;
+		for ( const auto& entry : nodes ) {
+			if ( entry.second->score.Validate ( ) != SafeVarStatus::Ok ||
+				Encode ( key, entry.second->score.Get ( ) ) != entry.second->orderKey ) {
+				ok = false;
+				break;
+			}
+		}
+		SecureWipe ( key.data ( ), key.size ( ) );
+		return ok && SizeOf ( root ) == nodes.size ( );
+	}
+};
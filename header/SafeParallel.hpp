@@ -0,0 +1,413 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SafeVar.hpp"
+#include "SafeRegistry.hpp"
+
+/**
+ * @file    SafeParallel.hpp
+ * @brief   Parallel bulk operations over many SafeVar instances.
+ *
+ * Provides a small work-stealing thread pool, an executor interface so a host engine can run
+ * the work on its own job system, and SafeBulk helpers that split containers or registries of
+ * SafeVars into contiguous chunks and re-key, validate, snapshot or wipe them in parallel.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+/**
+ * @brief Executor interface used by all parallel SafeVar operations.
+ *
+ * Implement this to route the work through an engine job system. Dispatch() must not wait
+ * for the task to finish; the caller of a bulk operation always helps with the work itself,
+ * so an executor that is slow to pick tasks up (or never does) only costs parallelism.
+ */
+class SafeJobExecutor
+{
+public:
+	virtual ~SafeJobExecutor ( ) = default;
+
+	// Schedule a task on any thread
+	virtual void Dispatch ( std::function<void ( )> task ) = 0;
+
+	// Number of tasks that can usefully run at the same time
+	virtual size_t Concurrency ( ) const = 0;
+};
+
+// Built-in work-stealing pool: one deque per worker, owners pop from the back, thieves from the front
+class SafeThreadPool : public SafeJobExecutor
+{
+private:
+	struct WorkerQueue
+	{
+		std::deque<std::function<void ( )>> tasks;
+		std::mutex mtx;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> threads;
+	std::mutex sleepMtx;
+	std::condition_variable wake;
+	size_t pending = 0;
+	bool stopping = false;
+	std::atomic<size_t> nextQueue { 0 };
+
+	// Identity of the pool worker running on this thread (if any)
+	static const SafeThreadPool*& LocalPool ( )
+	{
+		static thread_local const SafeThreadPool* pool = nullptr;
+		return pool;
+	}
+
+	static size_t& LocalIndex ( )
+	{
+		static thread_local size_t index = 0;
+		return index;
+	}
+
+	bool TryTake ( size_t self, std::function<void ( )>& out )
+	{
+		{
+			WorkerQueue& own = *queues [ self ];
+			std::lock_guard<std::mutex> lock ( own.mtx );
+			if ( !own.tasks.empty ( ) ) {
+				out = std::move ( own.tasks.back ( ) );
+				own.tasks.pop_back ( );
+				return true;
+			}
+		}
+
+		// Steal the oldest task of another worker
+		for ( size_t i = 1; i < queues.size ( ); ++i ) {
+			WorkerQueue& victim = *queues [ ( self + i ) % queues.size ( ) ];
+			std::lock_guard<std::mutex> lock ( victim.mtx );
+			if ( !victim.tasks.empty ( ) ) {
+				out = std::move ( victim.tasks.front ( ) );
+				victim.tasks.pop_front ( );
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void WorkerLoop ( size_t self )
+	{
+		LocalPool ( ) = this;
+		LocalIndex ( ) = self;
+
+		for ( ;; ) {
+			std::function<void ( )> task;
+			if ( TryTake ( self, task ) ) {
+				{
+					std::lock_guard<std::mutex> lock ( sleepMtx );
+					--pending;
+				}
+				try {
+					task ( );
+				}
+				catch ( ... ) {
+					// Tasks report their own errors; a throwing task must not kill the worker
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock ( sleepMtx );
+			if ( stopping && pending == 0 ) {
+				return;
+			}
+			wake.wait ( lock, [ this ] { return stopping || pending > 0; } );
+		}
+	}
+
+public:
+	explicit SafeThreadPool ( size_t workerCount = std::thread::hardware_concurrency ( ) )
+	{
+		if ( workerCount == 0 ) workerCount = 1;
+
+		for ( size_t i = 0; i < workerCount; ++i ) {
+			queues.emplace_back ( new WorkerQueue ( ) );
+		}
+		for ( size_t i = 0; i < workerCount; ++i ) {
+			threads.emplace_back ( &SafeThreadPool::WorkerLoop, this, i );
+		}
+	}
+
+	SafeThreadPool ( const SafeThreadPool& ) = delete;
+	SafeThreadPool& operator=( const SafeThreadPool& ) = delete;
+
+	~SafeThreadPool ( )
+	{
+		{
+			std::lock_guard<std::mutex> lock ( sleepMtx );
+			stopping = true;
+		}
+		wake.notify_all ( );
+		for ( auto& thread : threads ) {
+			thread.join ( );
+		}
+	}
+
+	void Dispatch ( std::function<void ( )> task ) override
+	{
+		// Workers push onto their own queue (LIFO, cache-warm), external threads round-robin
+		size_t target = ( LocalPool ( ) == this )
+			? LocalIndex ( )
+			: nextQueue.fetch_add ( 1, std::memory_order_relaxed ) % queues.size ( );
+
+		// Count the task before it becomes visible, so a worker that takes it at once never
+		// decrements pending below zero
+		{
+			std::lock_guard<std::mutex> sleepLock ( sleepMtx );
+			++pending;
+			WorkerQueue& queue = *queues [ target ];
+			std::lock_guard<std::mutex> lock ( queue.mtx );
+			queue.tasks.push_back ( std::move ( task ) );
+		}
+		wake.notify_one ( );
+	}
+
+	size_t Concurrency ( ) const override
+	{
+		return threads.size ( );
+	}
+
+	// Process-wide pool used when a bulk operation does not name an executor
+	static SafeThreadPool& Default ( )
+	{
+		static SafeThreadPool pool;
+		return pool;
+	}
+};
+
+// Progress reporting and cancellation for a bulk operation. Safe to poll from any thread.
+class SafeBulkProgress
+{
+private:
+	std::atomic<size_t> total { 0 };
+	std::atomic<size_t> completed { 0 };
+	std::atomic<bool> cancelled { false };
+
+public:
+	void Begin ( size_t itemCount )
+	{
+		total.store ( itemCount, std::memory_order_relaxed );
+		completed.store ( 0, std::memory_order_relaxed );
+	}
+
+	void Advance ( size_t itemCount ) { completed.fetch_add ( itemCount, std::memory_order_relaxed ); }
+
+	// Chunks that have not started yet are skipped; chunks already running finish normally
+	void Cancel ( ) { cancelled.store ( true, std::memory_order_relaxed ); }
+	void Reset ( ) { cancelled.store ( false, std::memory_order_relaxed ); Begin ( 0 ); }
+
+	bool IsCancelled ( ) const { return cancelled.load ( std::memory_order_relaxed ); }
+	size_t Completed ( ) const { return completed.load ( std::memory_order_relaxed ); }
+	size_t Total ( ) const { return total.load ( std::memory_order_relaxed ); }
+
+	double Fraction ( ) const
+	{
+		size_t t = Total ( );
+		return t ? static_cast< double >( Completed ( ) ) / static_cast< double >( t ) : 1.0;
+	}
+};
+
+struct SafeBulkOptions
+{
+	SafeJobExecutor* executor = nullptr;   // nullptr selects SafeThreadPool::Default()
+	size_t chunkSize = 0;                  // 0 picks a size from the item count and executor width
+	SafeBulkProgress* progress = nullptr;  // optional progress/cancellation sink
+};
+
+/**
+ * @brief Chunked parallel operations over ranges of SafeVar<T> or SafeVar<T>*.
+ *
+ * Ranges must be random access. Each chunk is a contiguous index range, so neighbouring
+ * variables are processed by the same thread. All operations return false when cancelled.
+ */
+class SafeBulk
+{
+private:
+	struct ChunkJob
+	{
+		std::function<void ( size_t, size_t )> body;
+		size_t count = 0;
+		size_t chunkSize = 1;
+		size_t chunkCount = 0;
+		SafeBulkProgress* progress = nullptr;
+		std::atomic<size_t> nextChunk { 0 };
+		std::atomic<size_t> doneChunks { 0 };
+		std::atomic<bool> failed { false };
+		std::exception_ptr error;
+		std::mutex mtx;
+		std::condition_variable done;
+
+		// Claims chunks until none are left. Late tasks find nothing to do and only touch the counters.
+		void Run ( )
+		{
+			for ( ;; ) {
+				size_t chunk = nextChunk.fetch_add ( 1, std::memory_order_relaxed );
+				if ( chunk >= chunkCount ) return;
+
+				size_t begin = chunk * chunkSize;
+				size_t end = std::min ( begin + chunkSize, count );
+				bool skip = failed.load ( std::memory_order_relaxed ) || ( progress && progress->IsCancelled ( ) );
+
+				if ( !skip ) {
+					try {
+						body ( begin, end );
+						if ( progress ) progress->Advance ( end - begin );
+					}
+					catch ( ... ) {
+						std::lock_guard<std::mutex> lock ( mtx );
+						if ( !error ) error = std::current_exception ( );
+						failed.store ( true, std::memory_order_relaxed );
+					}
+				}
+
+				if ( doneChunks.fetch_add ( 1, std::memory_order_acq_rel ) + 1 == chunkCount ) {
+					std::lock_guard<std::mutex> lock ( mtx );
+					done.notify_all ( );
+				}
+			}
+		}
+	};
+
+	template<typename T> static SafeVar<T>& Target ( SafeVar<T>& var ) { return var; }
+	template<typename T> static const SafeVar<T>& Target ( const SafeVar<T>& var ) { return var; }
+	template<typename T> static SafeVar<T>& Target ( SafeVar<T>* var ) { return *var; }
+	template<typename T> static const SafeVar<T>& Target ( const SafeVar<T>* var ) { return *var; }
+
+public:
+	static constexpr size_t MIN_CHUNK_SIZE = 16;
+	static constexpr size_t MAX_CHUNK_SIZE = 4096;
+
+	// Splits [0, count) into chunks and runs body(begin, end) on the executor and the calling thread.
+	// Rethrows the first exception thrown by body after all started chunks have finished.
+	static bool ForEachChunk ( size_t count, const SafeBulkOptions& options, std::function<void ( size_t, size_t )> body )
+	{
+		if ( options.progress ) options.progress->Begin ( count );
+		if ( count == 0 ) return !( options.progress && options.progress->IsCancelled ( ) );
+
+		// A range that fits one chunk runs inline, without touching (or starting) any executor
+		if ( count <= ( options.chunkSize ? options.chunkSize : MIN_CHUNK_SIZE ) ) {
+			if ( options.progress && options.progress->IsCancelled ( ) ) return false;
+			body ( 0, count );
+			if ( options.progress ) options.progress->Advance ( count );
+			return !( options.progress && options.progress->IsCancelled ( ) );
+		}
+
+		size_t minChunk = MIN_CHUNK_SIZE, maxChunk = MAX_CHUNK_SIZE;
+		SafeJobExecutor& executor = options.executor ? *options.executor : SafeThreadPool::Default ( );
+		size_t width = std::max<size_t> ( executor.Concurrency ( ), 1 );
+
+		auto job = std::make_shared<ChunkJob> ( );
+		job->body = std::move ( body );
+		job->count = count;
+		job->chunkSize = options.chunkSize
+			? options.chunkSize
+			: std::min<size_t> ( std::max ( count / ( width * 4 ), minChunk ), maxChunk );
+		job->chunkCount = ( count + job->chunkSize - 1 ) / job->chunkSize;
+		job->progress = options.progress;
+
+		size_t helpers = std::min ( width, job->chunkCount ) - 1;
+		for ( size_t i = 0; i < helpers; ++i ) {
+			executor.Dispatch ( [ job ] { job->Run ( ); } );
+		}
+		job->Run ( );
+
+		{
+			std::unique_lock<std::mutex> lock ( job->mtx );
+			job->done.wait ( lock, [ &job ] { return job->doneChunks.load ( std::memory_order_acquire ) == job->chunkCount; } );
+		}
+
+		if ( job->error ) std::rethrow_exception ( job->error );
+		return !( options.progress && options.progress->IsCancelled ( ) );
+	}
+
+	template<typename It>
+	static bool ReKeyAll ( It first, It last, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		return ForEachChunk ( static_cast< size_t >( last - first ), options, [ first ] ( size_t begin, size_t end ) {
+			for ( size_t i = begin; i < end; ++i ) Target ( first [ i ] ).ReKey ( );
+		} );
+	}
+
+	// Returns the number of variables that failed validation; per-variable results go to statuses if given
+	template<typename It>
+	static size_t ValidateAll ( It first, It last, std::vector<SafeVarStatus>* statuses = nullptr, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		size_t count = static_cast< size_t >( last - first );
+		if ( statuses ) statuses->assign ( count, SafeVarStatus::Ok );
+
+		std::atomic<size_t> failures { 0 };
+		ForEachChunk ( count, options, [ first, statuses, &failures ] ( size_t begin, size_t end ) {
+			size_t local = 0;
+			for ( size_t i = begin; i < end; ++i ) {
+				SafeVarStatus status = Target ( first [ i ] ).Validate ( );
+				if ( statuses ) ( *statuses ) [ i ] = status;
+				if ( status != SafeVarStatus::Ok ) ++local;
+			}
+			failures.fetch_add ( local, std::memory_order_relaxed );
+		} );
+		return failures.load ( );
+	}
+
+	// Serialize() every variable into out (resized to the range length)
+	template<typename It, typename Blob>
+	static bool SnapshotAll ( It first, It last, std::vector<Blob>& out, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		out.resize ( static_cast< size_t >( last - first ) );
+		Blob* dst = out.data ( );
+		return ForEachChunk ( out.size ( ), options, [ first, dst ] ( size_t begin, size_t end ) {
+			for ( size_t i = begin; i < end; ++i ) dst [ i ] = Target ( first [ i ] ).Serialize ( );
+		} );
+	}
+
+	template<typename It>
+	static bool WipeAll ( It first, It last, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		return ForEachChunk ( static_cast< size_t >( last - first ), options, [ first ] ( size_t begin, size_t end ) {
+			for ( size_t i = begin; i < end; ++i ) Target ( first [ i ] ).Clear ( );
+		} );
+	}
+
+	// Registry overloads operate on a snapshot of the registered variables
+	template<typename T>
+	static bool ReKeyAll ( const SafeRegistry<T>& registry, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		std::vector<SafeVar<T>*> vars = registry.Snapshot ( );
+		return ReKeyAll ( vars.begin ( ), vars.end ( ), options );
+	}
+
+	template<typename T>
+	static size_t ValidateAll ( const SafeRegistry<T>& registry, std::vector<SafeVarStatus>* statuses = nullptr, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		std::vector<SafeVar<T>*> vars = registry.Snapshot ( );
+		return ValidateAll ( vars.begin ( ), vars.end ( ), statuses, options );
+	}
+
+	template<typename T, typename Blob>
+	static bool SnapshotAll ( const SafeRegistry<T>& registry, std::vector<Blob>& out, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		std::vector<SafeVar<T>*> vars = registry.Snapshot ( );
+		return SnapshotAll ( vars.begin ( ), vars.end ( ), out, options );
+	}
+
+	template<typename T>
+	static bool WipeAll ( const SafeRegistry<T>& registry, const SafeBulkOptions& options = SafeBulkOptions ( ) )
+	{
+		std::vector<SafeVar<T>*> vars = registry.Snapshot ( );
+		return WipeAll ( vars.begin ( ), vars.end ( ), options );
+	}
+};
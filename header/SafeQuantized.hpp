@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeQuantized.hpp
+ * @brief   Protected floating-point values stored as packed fixed-point codes.
+ *
+ * SafeQuantized<T, Bits, Range, Components> keeps Components values of the floating-point
+ * type T as Bits-bit codes over [Range::Min(), Range::Max()], bit-packed into the smallest
+ * unsigned word that holds them, and protects that word with one SafeVar. Three 16-bit
+ * coordinates take one 8-byte SafeVar instead of three 4-byte ones: a third of the Set()
+ * calls and fewer keystream bytes, for a precision of (Max - Min) / (2^Bits - 1).
+ *
+ * Set() clamps to the range and rounds to the nearest code (NaN becomes Min); Get() returns
+ * the code's value. Range is any type with static constexpr Min() and Max(); C++14 has no
+ * floating-point template arguments, so SafeRatioRange builds one from two std::ratio:
+ *
+ *   using Coordinate = SafeRatioRange<std::ratio<-4096>, std::ratio<4096>>;
+ *   SafeQuantized<float, 16, Coordinate, 3> position;   // x, y, z in 6 of 8 bytes
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+template<typename Lo, typename Hi>
+struct SafeRatioRange
+{
+	static constexpr double Min ( ) { return static_cast< double >( Lo::num ) / Lo::den; }
+	static constexpr double Max ( ) { return static_cast< double >( Hi::num ) / Hi::den; }
+};
+
+template<typename T, unsigned Bits, typename Range, size_t Components = 1>
+class SafeQuantized
+{
+	static_assert( std::is_floating_point<T>::value, "SafeQuantized quantizes floating-point values." );
+	static_assert( Bits >= 2 && Bits <= 32, "SafeQuantized supports 2 to 32 bits per component." );
+	static_assert( Components >= 1 && Bits * Components <= 64, "SafeQuantized components must pack into 64 bits." );
+	static_assert( Range::Min ( ) < Range::Max ( ), "SafeQuantized range must not be empty." );
+
+public:
+	static constexpr unsigned TOTAL_BITS = Bits * static_cast< unsigned >( Components );
+
+	// Smallest unsigned word holding every component
+	using Word = typename std::conditional<TOTAL_BITS <= 16, uint16_t,
+		typename std::conditional<TOTAL_BITS <= 32, uint32_t, uint64_t>::type>::type;
+	using Values = std::array<T, Components>;
+
+	static constexpr uint64_t MAX_CODE = ( 1ULL << Bits ) - 1;
+
+	// Distance between neighbouring values
+	static constexpr T Step ( ) { return static_cast< T >( ( Range::Max ( ) - Range::Min ( ) ) / MAX_CODE ); }
+
+	static uint64_t Quantize ( T value )
+	{
+		double v = static_cast< double >( value );
+		if ( !( v > Range::Min ( ) ) ) return 0;          // also catches NaN
+		if ( v >= Range::Max ( ) ) return MAX_CODE;
+		return static_cast< uint64_t >( std::llround ( ( v - Range::Min ( ) ) / ( Range::Max ( ) - Range::Min ( ) ) * MAX_CODE ) );
+	}
+
+	static T Dequantize ( uint64_t code )
+	{
+		return static_cast< T >( Range::Min ( ) + ( Range::Max ( ) - Range::Min ( ) ) * static_cast< double >( code ) / MAX_CODE );
+	}
+
+private:
+	SafeVar<Word> packed;
+
+	static uint64_t Extract ( Word word, size_t component )
+	{
+		return ( static_cast< uint64_t >( word ) >> ( component * Bits ) ) & MAX_CODE;
+	}
+
+	static Word Insert ( Word word, size_t component, uint64_t code )
+	{
+		uint64_t shift = component * Bits;
+		uint64_t cleared = static_cast< uint64_t >( word ) & ~( MAX_CODE << shift );
+		return static_cast< Word >( cleared | ( code << shift ) );
+	}
+
+	static Word Pack ( const Values& values )
+	{
+		Word word = 0;
+		for ( size_t i = 0; i < Components; ++i ) {
+			word = Insert ( word, i, Quantize ( values [ i ] ) );
+		}
+		return word;
+	}
+
+	static void CheckComponent ( size_t component )
+	{
+		if ( component >= Components ) {
+			throw std::out_of_range ( "SafeQuantized component index out of range" );
+		}
+	}
+
+public:
+	SafeQuantized ( ) : packed ( Pack ( Values { } ) ) { }
+	explicit SafeQuantized ( const Values& values ) : packed ( Pack ( values ) ) { }
+
+	// Single-component form: SafeQuantized<float, 16, Range> angle ( 1.5f );
+	template<size_t C = Components, typename = typename std::enable_if<C == 1>::type>
+	SafeQuantized ( T value ) : packed ( static_cast< Word >( Quantize ( value ) ) ) { }
+
+	T Get ( size_t component = 0 ) const
+	{
+		CheckComponent ( component );
+		Word word = packed.Get ( );
+		T value = Dequantize ( Extract ( word, component ) );
+		SecureWipe ( &word, sizeof ( word ) );
+		return value;
+	}
+
+	// All components from one decryption
+	Values GetAll ( ) const
+	{
+		Word word = packed.Get ( );
+		Values values;
+		for ( size_t i = 0; i < Components; ++i ) {
+			values [ i ] = Dequantize ( Extract ( word, i ) );
+		}
+		SecureWipe ( &word, sizeof ( word ) );
+		return values;
+	}
+
+	// One component: decrypts, replaces its code and re-encrypts the word
+	void Set ( size_t component, T value )
+	{
+		CheckComponent ( component );
+		Word word = Insert ( packed.Get ( ), component, Quantize ( value ) );
+		packed.Set ( word );
+		SecureWipe ( &word, sizeof ( word ) );
+	}
+
+	// All components with one encryption and no decryption
+	void SetAll ( const Values& values )
+	{
+		Word word = Pack ( values );
+		packed.Set ( word );
+		SecureWipe ( &word, sizeof ( word ) );
+	}
+
+	template<size_t C = Components, typename = typename std::enable_if<C == 1>::type>
+	void Set ( T value ) { packed.Set ( static_cast< Word >( Quantize ( value ) ) ); }
+
+	template<size_t C = Components, typename = typename std::enable_if<C == 1>::type>
+	operator T( ) const { return Get ( ); }
+
+	template<size_t C = Components, typename = typename std::enable_if<C == 1>::type>
+	SafeQuantized& operator=( T value )
+	{
+		Set ( value );
+		return *this;
+	}
+
+	// The protecting SafeVar, for validation, sweepers and attachments
+	SafeVar<Word>& Storage ( ) { return packed; }
+	const SafeVar<Word>& Storage ( ) const { return packed; }
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeQueue.hpp
+ * @brief   Lock-free bounded queue that keeps its entries encrypted.
+ *
+ * SafeQueue<T, Capacity> is a multi-producer/multi-consumer ring buffer (also valid for the
+ * single-producer/single-consumer case). Every entry is encrypted with ChaCha20 under the
+ * queue key, using the entry's 64-bit ticket as nonce, so no two entries ever share keystream.
+ * Push encrypts straight from the caller's value into the slot and Pop decrypts straight into
+ * the caller's output; no plaintext copy is stored and no allocation happens per element.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+template<typename T, size_t Capacity = 1024>
+class SafeQueue
+{
+	static_assert( std::is_trivially_copyable<T>::value,
+		"SafeQueue<T> requires trivially copyable types." );
+	static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0,
+		"SafeQueue capacity must be a power of two." );
+
+private:
+	static constexpr size_t VALUE_SIZE = sizeof ( T );
+	static constexpr size_t CACHE_LINE = 64;
+
+	// Each cell carries its own sequence number (Vyukov bounded queue)
+	struct alignas( CACHE_LINE ) Cell
+	{
+		std::atomic<uint64_t> sequence;
+		uint32_t checksum;
+		std::array<uint8_t, VALUE_SIZE> data;
+	};
+
+	alignas( CACHE_LINE ) std::atomic<uint64_t> enqueuePos { 0 };
+	alignas( CACHE_LINE ) std::atomic<uint64_t> dequeuePos { 0 };
+	alignas( CACHE_LINE ) std::array<uint8_t, 32> key;
+	std::array<Cell, Capacity> cells;
+
+	void Crypt ( const uint8_t* input, uint8_t* output, uint64_t ticket ) const
+	{
+		uint8_t nonce [ 12 ] = { };
+		std::memcpy ( nonce, &ticket, sizeof ( ticket ) );
+		ChaCha20::Encrypt ( input, output, VALUE_SIZE, key.data ( ), nonce );
+	}
+
+	uint32_t CellChecksum ( const Cell& cell, uint64_t ticket ) const
+	{
+		return ComputeChecksumFNV ( cell.data.data ( ), VALUE_SIZE ) ^ static_cast< uint32_t >( ticket * 0x9E3779B1u );
+	}
+
+public:
+	SafeQueue ( )
+	{
+		GenerateRandomBytes ( key.data ( ), key.size ( ) );
+		for ( size_t i = 0; i < Capacity; ++i ) {
+			cells [ i ].sequence.store ( i, std::memory_order_relaxed );
+			cells [ i ].checksum = 0;
+			cells [ i ].data.fill ( 0 );
+		}
+	}
+
+	SafeQueue ( const SafeQueue& ) = delete;
+	SafeQueue& operator=( const SafeQueue& ) = delete;
+
+	~SafeQueue ( )
+	{
+		SecureWipe ( key.data ( ), key.size ( ) );
+		for ( auto& cell : cells ) {
+			SecureWipe ( cell.data.data ( ), VALUE_SIZE );
+		}
+	}
+
+	// Returns false when the queue is full
+	bool TryPush ( const T& value )
+	{
+		uint64_t pos = enqueuePos.load ( std::memory_order_relaxed );
+		for ( ;; ) {
+			Cell& cell = cells [ pos & ( Capacity - 1 ) ];
+			uint64_t seq = cell.sequence.load ( std::memory_order_acquire );
+			int64_t diff = static_cast< int64_t >( seq ) - static_cast< int64_t >( pos );
+
+			if ( diff == 0 ) {
+				if ( enqueuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) ) {
+					Crypt ( reinterpret_cast< const uint8_t* >( &value ), cell.data.data ( ), pos );
+					cell.checksum = CellChecksum ( cell, pos );
+					cell.sequence.store ( pos + 1, std::memory_order_release );
+					return true;
+				}
+			}
+			else if ( diff < 0 ) {
+				return false;
+			}
+			else {
+				pos = enqueuePos.load ( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	// Returns false when the queue is empty. Throws if the stored entry was tampered with;
+	// the slot is released before throwing so the queue stays usable.
+	bool TryPop ( T& out )
+	{
+		uint64_t pos = dequeuePos.load ( std::memory_order_relaxed );
+		for ( ;; ) {
+			Cell& cell = cells [ pos & ( Capacity - 1 ) ];
+			uint64_t seq = cell.sequence.load ( std::memory_order_acquire );
+			int64_t diff = static_cast< int64_t >( seq ) - static_cast< int64_t >( pos + 1 );
+
+			if ( diff == 0 ) {
+				if ( dequeuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) ) {
+					bool intact = CellChecksum ( cell, pos ) == cell.checksum;
+					if ( intact ) {
+						Crypt ( cell.data.data ( ), reinterpret_cast< uint8_t* >( &out ), pos );
+					}
+					cell.data.fill ( 0 );
+					cell.sequence.store ( pos + Capacity, std::memory_order_release );
+
+					if ( !intact ) {
+						throw std::runtime_error ( "SafeQueue entry tampering detected" );
+					}
+					return true;
+				}
+			}
+			else if ( diff < 0 ) {
+				return false;
+			}
+			else {
+				pos = dequeuePos.load ( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	// Approximate number of queued entries (exact when no push/pop is in flight)
+	size_t Size ( ) const
+	{
+		uint64_t head = dequeuePos.load ( std::memory_order_relaxed );
+		uint64_t tail = enqueuePos.load ( std::memory_order_relaxed );
+		return tail > head ? static_cast< size_t >( tail - head ) : 0;
+	}
+
+	bool Empty ( ) const { return Size ( ) == 0; }
+
+	static constexpr size_t GetCapacity ( ) { return Capacity; }
+};
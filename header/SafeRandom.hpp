@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeRandom.hpp
+ * @brief   ChaCha20 game RNG whose state stays encrypted at rest.
+ *
+ * The generator state is just a 256-bit key, a 64-bit stream id and a block counter, held
+ * together in one SafeVar. Output is produced in batches of BATCH_BLOCKS ChaCha20 blocks;
+ * the batch is stored encrypted under a slice of the thread's SafeKeystream, like a SafeVar
+ * value, and every word is zeroed once drawn. A draw decrypts one word (usually from the
+ * cached keystream block) and the protected state is only decrypted once per refill.
+ *
+ * Seed(matchSeed, stream) derives the key deterministically, so a replay seeded with the
+ * same values reproduces the exact draw sequence. Satisfies UniformRandomBitGenerator and
+ * can drive the <random> distributions.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+class SafeRandom
+{
+public:
+	using result_type = uint32_t;
+	static constexpr size_t BATCH_BLOCKS = 64;
+
+private:
+	static constexpr size_t BATCH_WORDS = BATCH_BLOCKS * 64 / sizeof ( uint64_t );
+
+	struct GeneratorState
+	{
+		std::array<uint8_t, 32> key;
+		uint64_t stream;
+		uint64_t counter;
+	};
+
+	SafeVar<GeneratorState> state;
+
+	std::array<uint64_t, BATCH_WORDS> batch;
+	uint32_t batchEpoch = 0;
+	uint64_t batchPosition = 0;                // keystream slice of batch[0]
+	size_t position = BATCH_WORDS;
+	uint32_t spare = 0;
+	bool hasSpare = false;
+
+	void Refill ( )
+	{
+		// Peek instead of Get: the Set below re-keys the state anyway
+		GeneratorState current;
+		SafeVarStatus status = state.Peek ( current );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+
+		uint8_t nonce [ 8 ];
+		std::memcpy ( nonce, &current.stream, sizeof ( nonce ) );
+		ChaCha20::KeystreamBlocks ( current.key.data ( ), nonce, current.counter, reinterpret_cast< uint8_t* >( batch.data ( ) ), BATCH_BLOCKS );
+		current.counter += BATCH_BLOCKS;
+		state.Set ( current );
+		SecureWipe ( &current, sizeof ( current ) );
+
+		uint8_t* bytes = reinterpret_cast< uint8_t* >( batch.data ( ) );
+		SafeKeystream::Encrypt ( bytes, bytes, sizeof ( batch ), batchEpoch, batchPosition );
+		position = 0;
+	}
+
+	void Reset ( const std::array<uint8_t, 32>& newKey, uint64_t streamId )
+	{
+		GeneratorState fresh;
+		fresh.key = newKey;
+		fresh.stream = streamId;
+		fresh.counter = 0;
+		state.Set ( fresh );
+		SecureWipe ( &fresh, sizeof ( fresh ) );
+		SecureWipe ( batch.data ( ), sizeof ( batch ) );
+		position = BATCH_WORDS;
+		hasSpare = false;
+		spare = 0;
+	}
+
+public:
+	// Unpredictable generator keyed from the system entropy source
+	SafeRandom ( )
+	{
+		std::array<uint8_t, 32> k;
+		GenerateRandomBytes ( k.data ( ), k.size ( ) );
+		Reset ( k, 0 );
+		SecureWipe ( k.data ( ), k.size ( ) );
+	}
+
+	// Reproducible generator, see Seed()
+	explicit SafeRandom ( uint64_t matchSeed, uint64_t streamId = 0 )
+	{
+		Seed ( matchSeed, streamId );
+	}
+
+	SafeRandom ( const SafeRandom& ) = delete;
+	SafeRandom& operator=( const SafeRandom& ) = delete;
+
+	~SafeRandom ( )
+	{
+		SecureWipe ( batch.data ( ), sizeof ( batch ) );
+	}
+
+	/**
+	 * Derive the key from a per-match seed. Different streamIds give independent sequences
+	 * under one seed (e.g. one stream per system: loot, AI, spawns).
+	 */
+	void Seed ( uint64_t matchSeed, uint64_t streamId = 0 )
+	{
+		static const uint8_t derivationNonce [ 8 ] = { 'S', 'a', 'f', 'e', 'R', 'a', 'n', 'd' };
+		uint8_t seedKey [ 32 ] = { };
+		std::memcpy ( seedKey, &matchSeed, sizeof ( matchSeed ) );
+
+		uint8_t derived [ 64 ];
+		ChaCha20::KeystreamBlocks ( seedKey, derivationNonce, 0, derived, 1 );
+
+		std::array<uint8_t, 32> k;
+		std::memcpy ( k.data ( ), derived, k.size ( ) );
+		Reset ( k, streamId );
+
+		SecureWipe ( derived, sizeof ( derived ) );
+		SecureWipe ( seedKey, sizeof ( seedKey ) );
+		SecureWipe ( k.data ( ), k.size ( ) );
+	}
+
+	uint64_t Next64 ( )
+	{
+		if ( position == BATCH_WORDS ) Refill ( );
+		uint64_t value;
+		SafeKeystream::Apply ( batchEpoch, batchPosition + position * sizeof ( uint64_t ),
+			reinterpret_cast< const uint8_t* >( &batch [ position ] ), reinterpret_cast< uint8_t* >( &value ), sizeof ( value ) );
+		batch [ position++ ] = 0;
+		return value;
+	}
+
+	uint32_t Next32 ( )
+	{
+		if ( hasSpare ) {
+			hasSpare = false;
+			uint32_t value = spare;
+			spare = 0;
+			return value;
+		}
+		uint64_t value = Next64 ( );
+		spare = static_cast< uint32_t >( value >> 32 );
+		hasSpare = true;
+		return static_cast< uint32_t >( value );
+	}
+
+	result_type operator()( ) { return Next32 ( ); }
+	static constexpr result_type min ( ) { return 0; }
+	static constexpr result_type max ( ) { return std::numeric_limits<result_type>::max ( ); }
+
+	// Unbiased integer in [0, bound) (Lemire's multiply-and-reject)
+	uint32_t Below ( uint32_t bound )
+	{
+		if ( bound == 0 ) return 0;
+		uint64_t product = static_cast< uint64_t >( Next32 ( ) ) * bound;
+		uint32_t low = static_cast< uint32_t >( product );
+		if ( low < bound ) {
+			uint32_t threshold = static_cast< uint32_t >( -bound ) % bound;
+			while ( low < threshold ) {
+				product = static_cast< uint64_t >( Next32 ( ) ) * bound;
+				low = static_cast< uint32_t >( product );
+			}
+		}
+		return static_cast< uint32_t >( product >> 32 );
+	}
+
+	// Unbiased integer in [lo, hi]
+	int32_t Range ( int32_t lo, int32_t hi )
+	{
+		if ( hi <= lo ) return lo;
+		uint32_t span = static_cast< uint32_t >( static_cast< int64_t >( hi ) - lo + 1 );
+		if ( span == 0 ) return static_cast< int32_t >( Next32 ( ) );
+		return static_cast< int32_t >( static_cast< int64_t >( lo ) + Below ( span ) );
+	}
+
+	// Uniform float in [0, 1)
+	float NextFloat ( )
+	{
+		return static_cast< float >( Next32 ( ) >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	// Uniform double in [0, 1)
+	double NextDouble ( )
+	{
+		return static_cast< double >( Next64 ( ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+	}
+
+	// Bulk output for large requests (shuffles, procedural generation)
+	void Fill ( uint8_t* out, size_t len )
+	{
+		while ( len >= sizeof ( uint64_t ) ) {
+			uint64_t value = Next64 ( );
+			std::memcpy ( out, &value, sizeof ( value ) );
+			out += sizeof ( value );
+			len -= sizeof ( value );
+		}
+		if ( len ) {
+			uint64_t value = Next64 ( );
+			std::memcpy ( out, &value, len );
+			SecureWipe ( &value, sizeof ( value ) );
+		}
+	}
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeRegistry.hpp
+ * @brief   Opt-in registry of live SafeVar<T> instances.
+ *
+ * SafeVar itself does not track its instances. Code that wants to run bulk operations
+ * (re-key, validate, snapshot, wipe) over every protected value of a type registers the
+ * variables here and unregisters them before they are destroyed.
+ *
+ * A registry constructed with a SafeStateHash attaches every variable registered with an id
+ * to that hash, so Digest() tracks the combined state of the registry incrementally.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+template<typename T>
+class SafeRegistry
+{
+private:
+	std::vector<SafeVar<T>*> entries;
+	mutable std::mutex mtx;
+	SafeStateHash* stateHash = nullptr;
+
+public:
+	SafeRegistry ( ) = default;
+	explicit SafeRegistry ( SafeStateHash* hash ) : stateHash ( hash ) { }
+	SafeRegistry ( const SafeRegistry& ) = delete;
+	SafeRegistry& operator=( const SafeRegistry& ) = delete;
+
+	void Register ( SafeVar<T>* var )
+	{
+		if ( !var ) return;
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( std::find ( entries.begin ( ), entries.end ( ), var ) == entries.end ( ) ) {
+			entries.push_back ( var );
+		}
+	}
+
+	// Register and attach to the registry's state hash under a stable id
+	void Register ( SafeVar<T>* var, uint64_t stateId )
+	{
+		if ( !var ) return;
+		if ( stateHash ) var->AttachStateHash ( stateHash, stateId );
+		Register ( var );
+	}
+
+	void Unregister ( SafeVar<T>* var )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		auto it = std::find ( entries.begin ( ), entries.end ( ), var );
+		if ( it != entries.end ( ) ) {
+			// Leave attachments to other hashes alone
+			if ( stateHash && var->AttachedStateHash ( ) == stateHash ) var->DetachStateHash ( );
+			// Order is irrelevant, swap-remove keeps this O(1) after the search
+			*it = entries.back ( );
+			entries.pop_back ( );
+		}
+	}
+
+	// Copy of the current entry list. Bulk operations work on the snapshot so that
+	// registration from other threads is never blocked for the duration of a sweep.
+	std::vector<SafeVar<T>*> Snapshot ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return entries;
+	}
+
+	size_t Size ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return entries.size ( );
+	}
+
+	// Combined state digest of all variables registered with an id (0 without a state hash)
+	uint64_t Digest ( ) const
+	{
+		return stateHash ? stateHash->Digest ( ) : 0;
+	}
+
+	void Clear ( )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( stateHash ) {
+			for ( auto var : entries ) {
+				// Same guard as Unregister: leave attachments to other hashes alone
+				if ( var->AttachedStateHash ( ) == stateHash ) var->DetachStateHash ( );
+			}
+		}
+		entries.clear ( );
+	}
+};
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "SafeVar.hpp"
+
+#include <sddl.h>
+#pragma comment(lib, "Advapi32.lib")
+
+/**
+ * @file    SafeSharedArena.hpp
+ * @brief   Encrypted SafeVar slots in a named shared-memory section.
+ *
+ * One process (the writer) creates the arena and stores values into fixed-size slots.
+ * Other processes open the same section read-only and read the ciphertext in place; they
+ * need the arena key, which the writer exports through ExportKey() and hands over on a
+ * local channel it trusts (for example an ACL'd named pipe). Nothing but ciphertext ever
+ * lives in the shared section.
+ *
+ * Each slot is guarded by a sequence lock and carries a write generation, so readers get
+ * torn-free values without locks. Writers can additionally bracket several writes with
+ * BeginBatch()/EndBatch() and readers use ReadConsistent() to observe the batch atomically.
+ * Readers retry a slot or batch that is being written at most MAX_READ_RETRIES times, so a
+ * writer that dies mid-write makes reads fail instead of hanging.
+ *
+ * The section is created with a DACL that grants access to its owner and SYSTEM only, and
+ * Create() fails if a section of that name already exists.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+class SafeSharedArena
+{
+private:
+	static constexpr uint32_t MAGIC = 0x53564152;  // "SVAR"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t CACHE_LINE = 64;
+
+public:
+	static constexpr uint32_t MAX_READ_RETRIES = 1u << 20;
+
+private:
+	// Owner and SYSTEM only; other users cannot open the section
+	static constexpr const char* SECTION_SDDL = "D:P(A;;GA;;;OW)(A;;GA;;;SY)";
+
+	struct ArenaHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slotSize;
+		uint32_t slotCount;
+		uint32_t slotStride;
+		uint32_t reserved;
+		std::atomic<uint64_t> writeCounter;    // source of unique per-write nonces
+		std::atomic<uint64_t> batchSequence;   // odd while a batch is being written
+	};
+
+	struct SlotHeader
+	{
+		std::atomic<uint64_t> sequence;        // odd while the slot is being written
+		uint64_t generation;                   // number of completed writes to this slot
+		uint64_t ticket;                       // nonce of the current ciphertext
+		uint32_t checksum;                     // FNV of the ciphertext
+		uint32_t length;
+	};
+
+	static_assert( sizeof ( std::atomic<uint64_t> ) == sizeof ( uint64_t ),
+		"SafeSharedArena requires address-free 64-bit atomics." );
+
+	HANDLE mapping = nullptr;
+	uint8_t* view = nullptr;
+	size_t viewSize = 0;
+	bool writer = false;
+	std::array<uint8_t, 32> key;
+
+	SafeSharedArena ( ) = default;
+
+	static size_t HeaderSize ( )
+	{
+		return ( sizeof ( ArenaHeader ) + CACHE_LINE - 1 ) & ~( CACHE_LINE - 1 );
+	}
+
+	ArenaHeader& Header ( ) const { return *reinterpret_cast< ArenaHeader* >( view ); }
+
+	SlotHeader& Slot ( uint32_t index ) const
+	{
+		if ( index >= Header ( ).slotCount ) {
+			throw std::out_of_range ( "SafeSharedArena slot index out of range" );
+		}
+		return *reinterpret_cast< SlotHeader* >( view + HeaderSize ( ) + static_cast< size_t >( index ) * Header ( ).slotStride );
+	}
+
+	static uint8_t* SlotData ( SlotHeader& slot ) { return reinterpret_cast< uint8_t* >( &slot + 1 ); }
+
+	// Spin-wait hint between sequence lock retries
+	static void Backoff ( )
+	{
+#ifdef SAFEVAR_CHACHA_SSE2
+		_mm_pause ( );
+#else
+		YieldProcessor ( );
+#endif
+	}
+
+	void Crypt ( const uint8_t* input, uint8_t* output, size_t length, uint64_t ticket ) const
+	{
+		uint8_t nonce [ 12 ] = { };
+		std::memcpy ( nonce, &ticket, sizeof ( ticket ) );
+		ChaCha20::Encrypt ( input, output, length, key.data ( ), nonce );
+	}
+
+public:
+	SafeSharedArena ( const SafeSharedArena& ) = delete;
+	SafeSharedArena& operator=( const SafeSharedArena& ) = delete;
+
+	~SafeSharedArena ( )
+	{
+		SecureWipe ( key.data ( ), key.size ( ) );
+		if ( view ) UnmapViewOfFile ( view );
+		if ( mapping ) CloseHandle ( mapping );
+	}
+
+	// Create a named arena with slotCount slots of slotSize bytes and a fresh random key
+	static std::unique_ptr<SafeSharedArena> Create ( const std::string& name, uint32_t slotSize, uint32_t slotCount )
+	{
+		if ( slotSize == 0 || slotCount == 0 ) {
+			throw std::invalid_argument ( "SafeSharedArena requires non-zero slot size and count" );
+		}
+
+		uint32_t stride = static_cast< uint32_t >( ( sizeof ( SlotHeader ) + slotSize + CACHE_LINE - 1 ) & ~( CACHE_LINE - 1 ) );
+		uint64_t total = HeaderSize ( ) + static_cast< uint64_t >( stride ) * slotCount;
+
+		std::unique_ptr<SafeSharedArena> arena ( new SafeSharedArena ( ) );
+		arena->writer = true;
+		arena->viewSize = static_cast< size_t >( total );
+
+		PSECURITY_DESCRIPTOR descriptor = nullptr;
+		if ( !ConvertStringSecurityDescriptorToSecurityDescriptorA ( SECTION_SDDL, SDDL_REVISION_1, &descriptor, NULL ) ) {
+			throw std::runtime_error ( "SafeSharedArena: cannot build the section security descriptor" );
+		}
+		SECURITY_ATTRIBUTES security = { sizeof ( SECURITY_ATTRIBUTES ), descriptor, FALSE };
+		arena->mapping = CreateFileMappingA ( INVALID_HANDLE_VALUE, &security, PAGE_READWRITE,
+			static_cast< DWORD >( total >> 32 ), static_cast< DWORD >( total & 0xFFFFFFFF ), name.c_str ( ) );
+		DWORD error = GetLastError ( );
+		LocalFree ( descriptor );
+		if ( !arena->mapping ) {
+			throw std::runtime_error ( "SafeSharedArena: CreateFileMapping failed" );
+		}
+		// Never adopt (and reinitialise) a section someone else created first
+		if ( error == ERROR_ALREADY_EXISTS ) {
+			throw std::runtime_error ( "SafeSharedArena: section " + name + " already exists" );
+		}
+
+		arena->view = static_cast< uint8_t* >( MapViewOfFile ( arena->mapping, FILE_MAP_ALL_ACCESS, 0, 0, arena->viewSize ) );
+		if ( !arena->view ) {
+			throw std::runtime_error ( "SafeSharedArena: MapViewOfFile failed" );
+		}
+
+		GenerateRandomBytes ( arena->key.data ( ), arena->key.size ( ) );
+
+		ArenaHeader* header = new ( arena->view ) ArenaHeader;
+		header->slotSize = slotSize;
+		header->slotCount = slotCount;
+		header->slotStride = stride;
+		header->reserved = 0;
+		header->writeCounter.store ( 0, std::memory_order_relaxed );
+		header->batchSequence.store ( 0, std::memory_order_relaxed );
+
+		for ( uint32_t i = 0; i < slotCount; ++i ) {
+			SlotHeader* slot = new ( arena->view + HeaderSize ( ) + static_cast< size_t >( i ) * stride ) SlotHeader;
+			slot->sequence.store ( 0, std::memory_order_relaxed );
+			slot->generation = 0;
+			slot->ticket = 0;
+			slot->checksum = 0;
+			slot->length = 0;
+		}
+
+		// Publish the header last so readers never see a half-initialised arena
+		header->version = VERSION;
+		std::atomic_thread_fence ( std::memory_order_release );
+		header->magic = MAGIC;
+		return arena;
+	}
+
+	// Open an existing arena read-only with the key exported by the writer
+	static std::unique_ptr<SafeSharedArena> Open ( const std::string& name, const std::array<uint8_t, 32>& arenaKey )
+	{
+		std::unique_ptr<SafeSharedArena> arena ( new SafeSharedArena ( ) );
+		arena->mapping = OpenFileMappingA ( FILE_MAP_READ, FALSE, name.c_str ( ) );
+		if ( !arena->mapping ) {
+			throw std::runtime_error ( "SafeSharedArena: OpenFileMapping failed" );
+		}
+
+		// Map the header first to learn the full size
+		auto* header = static_cast< const ArenaHeader* >( MapViewOfFile ( arena->mapping, FILE_MAP_READ, 0, 0, sizeof ( ArenaHeader ) ) );
+		if ( !header ) {
+			throw std::runtime_error ( "SafeSharedArena: MapViewOfFile failed" );
+		}
+		bool valid = header->magic == MAGIC && header->version == VERSION;
+		size_t total = HeaderSize ( ) + static_cast< size_t >( header->slotStride ) * header->slotCount;
+		UnmapViewOfFile ( header );
+		if ( !valid ) {
+			throw std::runtime_error ( "SafeSharedArena: invalid or incompatible arena" );
+		}
+
+		arena->viewSize = total;
+		arena->view = static_cast< uint8_t* >( MapViewOfFile ( arena->mapping, FILE_MAP_READ, 0, 0, total ) );
+		if ( !arena->view ) {
+			throw std::runtime_error ( "SafeSharedArena: MapViewOfFile failed" );
+		}
+		arena->key = arenaKey;
+		return arena;
+	}
+
+	// Key material for reader processes. Transport it only over an authenticated local channel.
+	std::array<uint8_t, 32> ExportKey ( ) const { return key; }
+
+	bool IsWriter ( ) const { return writer; }
+	uint32_t SlotCount ( ) const { return Header ( ).slotCount; }
+	uint32_t SlotSize ( ) const { return Header ( ).slotSize; }
+
+	// Writer side: encrypt value into slot. Single writer per slot.
+	template<typename T>
+	void Write ( uint32_t index, const T& value )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "SafeSharedArena values must be trivially copyable." );
+		if ( !writer ) throw std::runtime_error ( "SafeSharedArena: write on a read-only arena" );
+		if ( sizeof ( T ) > Header ( ).slotSize ) throw std::length_error ( "SafeSharedArena: value larger than slot" );
+
+		SlotHeader& slot = Slot ( index );
+		uint64_t ticket = Header ( ).writeCounter.fetch_add ( 1, std::memory_order_relaxed ) + 1;
+		uint64_t seq = slot.sequence.load ( std::memory_order_relaxed );
+
+		slot.sequence.store ( seq + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence ( std::memory_order_release );
+
+		Crypt ( reinterpret_cast< const uint8_t* >( &value ), SlotData ( slot ), sizeof ( T ), ticket );
+		slot.ticket = ticket;
+		slot.length = static_cast< uint32_t >( sizeof ( T ) );
+		slot.checksum = ComputeChecksumFNV ( SlotData ( slot ), sizeof ( T ) );
+		++slot.generation;
+
+		slot.sequence.store ( seq + 2, std::memory_order_release );
+	}
+
+	// Group several writes so ReadConsistent() observes all or none of them
+	void BeginBatch ( ) { Header ( ).batchSequence.fetch_add ( 1, std::memory_order_acq_rel ); }
+	void EndBatch ( ) { Header ( ).batchSequence.fetch_add ( 1, std::memory_order_release ); }
+
+	/**
+	 * Read and decrypt a slot. Returns false if the slot was never written, holds a value of a
+	 * different size, fails its checksum, or stayed mid-write for MAX_READ_RETRIES attempts.
+	 * generationOut receives the slot's write generation.
+	 */
+	template<typename T>
+	bool Read ( uint32_t index, T& out, uint64_t* generationOut = nullptr ) const
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "SafeSharedArena values must be trivially copyable." );
+		SlotHeader& slot = Slot ( index );
+
+		std::array<uint8_t, sizeof ( T )> cipher;
+		uint64_t generation, ticket;
+		uint32_t checksum, length;
+		for ( uint32_t attempt = 0;; ++attempt ) {
+			if ( attempt == MAX_READ_RETRIES ) return false;
+
+			uint64_t before = slot.sequence.load ( std::memory_order_acquire );
+			if ( before & 1 ) {
+				Backoff ( );
+				continue;
+			}
+
+			generation = slot.generation;
+			ticket = slot.ticket;
+			checksum = slot.checksum;
+			length = slot.length;
+			std::memcpy ( cipher.data ( ), SlotData ( slot ), std::min<size_t> ( sizeof ( T ), Header ( ).slotSize ) );
+
+			std::atomic_thread_fence ( std::memory_order_acquire );
+			if ( slot.sequence.load ( std::memory_order_relaxed ) == before ) break;
+			Backoff ( );
+		}
+
+		if ( generation == 0 || length != sizeof ( T ) ) return false;
+		if ( ComputeChecksumFNV ( cipher.data ( ), sizeof ( T ) ) != checksum ) return false;
+
+		Crypt ( cipher.data ( ), reinterpret_cast< uint8_t* >( &out ), sizeof ( T ), ticket );
+		if ( generationOut ) *generationOut = generation;
+		return true;
+	}
+
+	// Runs reader(arena) until it completes without a batch being written concurrently.
+	// Returns false after MAX_READ_RETRIES attempts without a consistent pass.
+	template<typename Fn>
+	bool ReadConsistent ( Fn&& reader ) const
+	{
+		for ( uint32_t attempt = 0; attempt < MAX_READ_RETRIES; ++attempt ) {
+			uint64_t before = Header ( ).batchSequence.load ( std::memory_order_acquire );
+			if ( before & 1 ) {
+				Backoff ( );
+				continue;
+			}
+
+			reader ( *this );
+
+			std::atomic_thread_fence ( std::memory_order_acquire );
+			if ( Header ( ).batchSequence.load ( std::memory_order_relaxed ) == before ) return true;
+			Backoff ( );
+		}
+		return false;
+	}
+
+	// Value of the batch counter; unchanged values mean no batch completed in between
+	uint64_t BatchGeneration ( ) const { return Header ( ).batchSequence.load ( std::memory_order_acquire ) / 2; }
+};
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "SafeVar.hpp"
+#include "SafeRegistry.hpp"
+
+/**
+ * @file    SafeSweeper.hpp
+ * @brief   Write-generation sweeper for freeze and rollback detection.
+ *
+ * Every legitimate write advances a SafeVar's write generation, which is sealed together with
+ * the ciphertext checksum. A memory freezer that restores old bytes therefore either breaks
+ * the seal or leaves the generation stuck or moving backwards. The sweeper remembers the last
+ * generation it saw per watched variable and, once per Sweep(), performs one O(1) check each:
+ *
+ *  - SealBroken: generation and ciphertext no longer belong together
+ *  - Rollback:   the generation went backwards (an older copy of the variable was restored)
+ *  - Stalled:    a variable with a heartbeat was not written within its expected number of sweeps
+ *
+ * Heartbeats suit values that legitimate code rewrites on a schedule (per-frame timers,
+ * regenerating resources). Sweep from the thread that writes the variables, or between frames.
+ * Moving a different SafeVar into a watched one changes its generation; call Rebase() after.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+struct SafeFreezeEvent
+{
+	enum class Kind : uint8_t
+	{
+		SealBroken,
+		Rollback,
+		Stalled
+	};
+
+	Kind kind;
+	uint64_t id;
+	uint64_t lastGeneration;     // generation seen by the previous sweep
+	uint64_t generation;         // generation seen now (unchanged for SealBroken)
+};
+
+class SafeGenerationSweeper
+{
+public:
+	using DetectionHandler = std::function<void ( const SafeFreezeEvent& )>;
+
+private:
+	using CheckFn = SafeVarStatus ( * )( const void* var, uint64_t& generation );
+
+	struct Entry
+	{
+		const void* var;
+		CheckFn check;
+		uint64_t id;
+		uint64_t lastGeneration;
+		uint32_t heartbeatSweeps;    // 0 = no heartbeat
+		uint32_t idleSweeps;
+	};
+
+	std::vector<Entry> entries;
+	mutable std::mutex mtx;
+	DetectionHandler handler;
+	uint64_t detections = 0;
+
+	template<typename T>
+	static SafeVarStatus Check ( const void* var, uint64_t& generation )
+	{
+		return static_cast< const SafeVar<T>* >( var )->CheckGeneration ( generation );
+	}
+
+	template<typename T>
+	static uint64_t CurrentGeneration ( const SafeVar<T>& var )
+	{
+		uint64_t generation = 0;
+		SafeVarStatus status = var.CheckGeneration ( generation );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+		return generation;
+	}
+
+	void Report ( std::vector<SafeFreezeEvent>& events, SafeFreezeEvent::Kind kind, const Entry& entry, uint64_t generation )
+	{
+		events.push_back ( { kind, entry.id, entry.lastGeneration, generation } );
+	}
+
+public:
+	SafeGenerationSweeper ( ) = default;
+	SafeGenerationSweeper ( const SafeGenerationSweeper& ) = delete;
+	SafeGenerationSweeper& operator=( const SafeGenerationSweeper& ) = delete;
+
+	/**
+	 * Start watching a variable. heartbeatSweeps > 0 demands at least one write every that many
+	 * sweeps; 0 only checks the seal and rollbacks. The variable must outlive its registration.
+	 */
+	template<typename T>
+	void Watch ( const SafeVar<T>& var, uint64_t id, uint32_t heartbeatSweeps = 0 )
+	{
+		uint64_t generation = CurrentGeneration ( var );
+		std::lock_guard<std::mutex> lock ( mtx );
+		for ( Entry& entry : entries ) {
+			if ( entry.var == &var ) {
+				entry.id = id;
+				entry.lastGeneration = generation;
+				entry.heartbeatSweeps = heartbeatSweeps;
+				entry.idleSweeps = 0;
+				return;
+			}
+		}
+		entries.push_back ( { &var, &Check<T>, id, generation, heartbeatSweeps, 0 } );
+	}
+
+	// Watch every variable currently in a registry; ids are the registration order
+	template<typename T>
+	void WatchAll ( const SafeRegistry<T>& registry, uint32_t heartbeatSweeps = 0, uint64_t firstId = 0 )
+	{
+		for ( SafeVar<T>* var : registry.Snapshot ( ) ) {
+			Watch ( *var, firstId++, heartbeatSweeps );
+		}
+	}
+
+	template<typename T>
+	void Unwatch ( const SafeVar<T>& var )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		for ( size_t i = 0; i < entries.size ( ); ++i ) {
+			if ( entries [ i ].var == &var ) {
+				entries [ i ] = entries.back ( );
+				entries.pop_back ( );
+				return;
+			}
+		}
+	}
+
+	// Accept the variable's current generation as the new baseline (after a move into it)
+	template<typename T>
+	void Rebase ( const SafeVar<T>& var )
+	{
+		uint64_t generation = CurrentGeneration ( var );
+		std::lock_guard<std::mutex> lock ( mtx );
+		for ( Entry& entry : entries ) {
+			if ( entry.var == &var ) {
+				entry.lastGeneration = generation;
+				entry.idleSweeps = 0;
+				return;
+			}
+		}
+	}
+
+	void SetDetectionHandler ( DetectionHandler detectionHandler )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		handler = std::move ( detectionHandler );
+	}
+
+	// One O(1) check per watched variable; returns the number of detections in this sweep
+	size_t Sweep ( )
+	{
+		std::vector<SafeFreezeEvent> events;
+		DetectionHandler notify;
+		{
+			std::lock_guard<std::mutex> lock ( mtx );
+			for ( Entry& entry : entries ) {
+				uint64_t generation = entry.lastGeneration;
+				if ( entry.check ( entry.var, generation ) != SafeVarStatus::Ok ) {
+					Report ( events, SafeFreezeEvent::Kind::SealBroken, entry, generation );
+					continue;
+				}
+
+				if ( generation < entry.lastGeneration ) {
+					Report ( events, SafeFreezeEvent::Kind::Rollback, entry, generation );
+				}
+				else if ( generation == entry.lastGeneration ) {
+					if ( entry.heartbeatSweeps && ++entry.idleSweeps >= entry.heartbeatSweeps ) {
+						Report ( events, SafeFreezeEvent::Kind::Stalled, entry, generation );
+						entry.idleSweeps = 0;
+					}
+					continue;
+				}
+
+				entry.lastGeneration = generation;
+				entry.idleSweeps = 0;
+			}
+			detections += events.size ( );
+			notify = handler;
+		}
+
+		// Handlers run outside the lock so they may Unwatch/Rebase
+		if ( notify ) {
+			for ( const SafeFreezeEvent& event : events ) notify ( event );
+		}
+		return events.size ( );
+	}
+
+	size_t Size ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return entries.size ( );
+	}
+
+	uint64_t DetectionCount ( ) const
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return detections;
+	}
+};
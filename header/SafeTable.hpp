@@ -0,0 +1,265 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeTable.hpp
+ * @brief   Read-only encrypted asset tables, mapped from disk and decrypted per row on access.
+ *
+ * Balance data (item stats, drop rates) is encrypted offline with SafeTableWriter into a file:
+ *
+ *   header: magic "SVT1" | version | row size | row count | nonce 8 | header tag 8
+ *   rows:   ciphertext (row size) | tag 8, repeated row count times
+ *
+ * Row i uses its own span of the (key, nonce) ChaCha20 stream starting at block
+ * 1 + i * BLOCKS_PER_ROW. The first 16 bytes of that span are the row's SipHash key, and the rest
+ * encrypts the row, so a row cannot be moved to another index without failing its tag. The header
+ * tag is keyed from block 0.
+ *
+ * At runtime SafeTable<Row>::Open maps the file read-only, so server processes that open the same
+ * file share its pages through the page cache. Opening only checks the header: there is no parse,
+ * no re-encryption and no allocation per row. Rows are authenticated and decrypted only when read,
+ * and the plaintext exists only in the caller's copy.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+struct SafeTableFormat
+{
+	static constexpr uint32_t MAGIC = 0x31545653;  // "SVT1"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t HEADER_SIZE = 32;
+	static constexpr size_t TAG_SIZE = 8;
+	static constexpr size_t ROW_KEY_SIZE = 16;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t rowSize;
+		uint32_t rowCount;
+		uint8_t nonce [ 8 ];
+		uint64_t tag;
+	};
+	static_assert( sizeof ( Header ) == HEADER_SIZE, "SafeTableFormat::Header must be packed." );
+
+	static constexpr size_t RowStride ( size_t rowSize ) { return rowSize + TAG_SIZE; }
+	static constexpr size_t BlocksPerRow ( size_t rowSize ) { return ( ROW_KEY_SIZE + rowSize + 63 ) / 64; }
+	static constexpr size_t FileSize ( size_t rowSize, size_t rowCount ) { return HEADER_SIZE + RowStride ( rowSize ) * rowCount; }
+
+	// Header tag over every field before it, keyed from keystream block 0
+	static uint64_t HeaderTag ( const uint8_t* key, const Header& header )
+	{
+		uint8_t block0 [ 64 ];
+		ChaCha20::KeystreamBlocks ( key, header.nonce, 0, block0, 1 );
+		uint64_t tag = ComputeSipHash ( block0, reinterpret_cast< const uint8_t* >( &header ), offsetof ( Header, tag ) );
+		SecureWipe ( block0, sizeof ( block0 ) );
+		return tag;
+	}
+};
+
+class SafeTableWriter
+{
+public:
+	/**
+	 * Encrypt count rows under a 32-byte table key into the SafeTable file image. Meant for the
+	 * offline build step; the nonce is random, so rebuilding a table never reuses keystream.
+	 */
+	template<typename Row>
+	static std::vector<uint8_t> Build ( const uint8_t* key, const Row* rows, size_t count )
+	{
+		static_assert( std::is_trivially_copyable<Row>::value, "SafeTable rows must be trivially copyable." );
+		constexpr size_t ROW_SIZE = sizeof ( Row );
+		constexpr size_t BLOCKS = SafeTableFormat::BlocksPerRow ( ROW_SIZE );
+		if ( count > UINT32_MAX ) {
+			throw std::length_error ( "SafeTableWriter: too many rows" );
+		}
+
+		std::vector<uint8_t> image ( SafeTableFormat::FileSize ( ROW_SIZE, count ) );
+
+		SafeTableFormat::Header header;
+		header.magic = SafeTableFormat::MAGIC;
+		header.version = SafeTableFormat::VERSION;
+		header.rowSize = static_cast< uint32_t >( ROW_SIZE );
+		header.rowCount = static_cast< uint32_t >( count );
+		GenerateRandomBytes ( header.nonce, sizeof ( header.nonce ) );
+		header.tag = SafeTableFormat::HeaderTag ( key, header );
+		std::memcpy ( image.data ( ), &header, sizeof ( header ) );
+
+		std::array<uint8_t, BLOCKS * 64> stream;
+		for ( size_t i = 0; i < count; ++i ) {
+			uint8_t* row = image.data ( ) + SafeTableFormat::HEADER_SIZE + i * SafeTableFormat::RowStride ( ROW_SIZE );
+			ChaCha20::KeystreamBlocks ( key, header.nonce, 1 + i * BLOCKS, stream.data ( ), BLOCKS );
+
+			const uint8_t* plain = reinterpret_cast< const uint8_t* >( &rows [ i ] );
+			const uint8_t* mask = stream.data ( ) + SafeTableFormat::ROW_KEY_SIZE;
+			for ( size_t b = 0; b < ROW_SIZE; ++b ) {
+				row [ b ] = plain [ b ] ^ mask [ b ];
+			}
+			uint64_t tag = ComputeSipHash ( stream.data ( ), row, ROW_SIZE );
+			std::memcpy ( row + ROW_SIZE, &tag, SafeTableFormat::TAG_SIZE );
+		}
+		SecureWipe ( stream.data ( ), stream.size ( ) );
+		return image;
+	}
+
+	template<typename Row>
+	static void Write ( const std::string& path, const uint8_t* key, const Row* rows, size_t count )
+	{
+		std::vector<uint8_t> image = Build ( key, rows, count );
+		std::ofstream file ( path, std::ios::binary | std::ios::trunc );
+		file.write ( reinterpret_cast< const char* >( image.data ( ) ), static_cast< std::streamsize >( image.size ( ) ) );
+		if ( !file ) {
+			throw std::runtime_error ( "SafeTableWriter: failed to write " + path );
+		}
+	}
+};
+
+template<typename Row>
+class SafeTable
+{
+	static_assert( std::is_trivially_copyable<Row>::value, "SafeTable rows must be trivially copyable." );
+
+	static constexpr size_t ROW_SIZE = sizeof ( Row );
+	static constexpr size_t BLOCKS = SafeTableFormat::BlocksPerRow ( ROW_SIZE );
+
+	HANDLE mapping = nullptr;
+	const uint8_t* view = nullptr;       // mapped file, or caller-owned memory
+	bool mapped = false;
+	uint32_t rowCount = 0;
+	uint8_t nonce [ 8 ];
+	std::array<uint8_t, 32> key;
+
+	SafeTable ( ) = default;
+
+	// Header check shared by both constructors; size is the number of readable bytes at data
+	void Attach ( const uint8_t* data, size_t size, const uint8_t* tableKey )
+	{
+		if ( size < SafeTableFormat::HEADER_SIZE ) {
+			throw std::runtime_error ( "SafeTable: file too small" );
+		}
+
+		SafeTableFormat::Header header;
+		std::memcpy ( &header, data, sizeof ( header ) );
+		if ( header.magic != SafeTableFormat::MAGIC || header.version != SafeTableFormat::VERSION ) {
+			throw std::runtime_error ( "SafeTable: invalid or incompatible table" );
+		}
+		if ( header.rowSize != ROW_SIZE ) {
+			throw std::runtime_error ( "SafeTable: row size does not match the row type" );
+		}
+		if ( size != SafeTableFormat::FileSize ( ROW_SIZE, header.rowCount ) ) {
+			throw std::runtime_error ( "SafeTable: truncated table" );
+		}
+		if ( header.tag != SafeTableFormat::HeaderTag ( tableKey, header ) ) {
+			throw std::runtime_error ( "SafeTable: header authentication failed" );
+		}
+
+		view = data;
+		rowCount = header.rowCount;
+		std::memcpy ( nonce, header.nonce, sizeof ( nonce ) );
+		std::memcpy ( key.data ( ), tableKey, key.size ( ) );
+	}
+
+public:
+	SafeTable ( const SafeTable& ) = delete;
+	SafeTable& operator=( const SafeTable& ) = delete;
+
+	~SafeTable ( )
+	{
+		SecureWipe ( key.data ( ), key.size ( ) );
+		if ( mapped ) UnmapViewOfFile ( view );
+		if ( mapping ) CloseHandle ( mapping );
+	}
+
+	// Map a table file read-only. Only the header is read and checked here.
+	static std::unique_ptr<SafeTable> Open ( const std::string& path, const uint8_t* tableKey )
+	{
+		HANDLE file = CreateFileA ( path.c_str ( ), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+		if ( file == INVALID_HANDLE_VALUE ) {
+			throw std::runtime_error ( "SafeTable: cannot open " + path );
+		}
+
+		LARGE_INTEGER size;
+		if ( !GetFileSizeEx ( file, &size ) || size.QuadPart < static_cast< long long >( SafeTableFormat::HEADER_SIZE ) ) {
+			CloseHandle ( file );
+			throw std::runtime_error ( "SafeTable: invalid file size" );
+		}
+
+		std::unique_ptr<SafeTable> table ( new SafeTable ( ) );
+		table->mapping = CreateFileMappingA ( file, NULL, PAGE_READONLY, 0, 0, NULL );
+		CloseHandle ( file );   // the mapping keeps the file open
+		if ( !table->mapping ) {
+			throw std::runtime_error ( "SafeTable: CreateFileMapping failed" );
+		}
+
+		table->view = static_cast< const uint8_t* >( MapViewOfFile ( table->mapping, FILE_MAP_READ, 0, 0, 0 ) );
+		if ( !table->view ) {
+			throw std::runtime_error ( "SafeTable: MapViewOfFile failed" );
+		}
+		table->mapped = true;
+		table->Attach ( table->view, static_cast< size_t >( size.QuadPart ), tableKey );
+		return table;
+	}
+
+	// Use a table image already in memory (embedded resource, network download); data must outlive the table
+	static std::unique_ptr<SafeTable> FromMemory ( const uint8_t* data, size_t size, const uint8_t* tableKey )
+	{
+		std::unique_ptr<SafeTable> table ( new SafeTable ( ) );
+		table->Attach ( data, size, tableKey );
+		return table;
+	}
+
+	size_t RowCount ( ) const { return rowCount; }
+
+	// Authenticate and decrypt one row. out is only written on Ok.
+	SafeBlobStatus Read ( size_t index, Row& out ) const
+	{
+		if ( index >= rowCount ) {
+			throw std::out_of_range ( "SafeTable row index out of range" );
+		}
+
+		const uint8_t* row = view + SafeTableFormat::HEADER_SIZE + index * SafeTableFormat::RowStride ( ROW_SIZE );
+		std::array<uint8_t, BLOCKS * 64> stream;
+		ChaCha20::KeystreamBlocks ( key.data ( ), nonce, 1 + index * BLOCKS, stream.data ( ), BLOCKS );
+
+		uint64_t expected = ComputeSipHash ( stream.data ( ), row, ROW_SIZE ), actual;
+		std::memcpy ( &actual, row + ROW_SIZE, SafeTableFormat::TAG_SIZE );
+		SafeBlobStatus status = SafeBlobStatus::AuthenticationFailed;
+		if ( ( expected ^ actual ) == 0 ) {
+			uint8_t* bytes = reinterpret_cast< uint8_t* >( &out );
+			const uint8_t* mask = stream.data ( ) + SafeTableFormat::ROW_KEY_SIZE;
+			for ( size_t b = 0; b < ROW_SIZE; ++b ) {
+				bytes [ b ] = row [ b ] ^ mask [ b ];
+			}
+			status = SafeBlobStatus::Ok;
+		}
+		SecureWipe ( stream.data ( ), stream.size ( ) );
+		return status;
+	}
+
+	// Throwing variant of Read()
+	Row Get ( size_t index ) const
+	{
+		Row row;
+		SafeBlobStatus status = Read ( index, row );
+		if ( status != SafeBlobStatus::Ok ) {
+			throw std::runtime_error ( SafeBlobStatusMessage ( status ) );
+		}
+		return row;
+	}
+
+	Row operator[]( size_t index ) const { return Get ( index ); }
+};
@@ -14,10 +14,19 @@
 #include <algorithm>
 #include <numeric>
 #include <stdexcept>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 
 #include <intrin.h>
 #pragma intrinsic(_ReturnAddress)
 
+#if defined( _M_X64 ) || defined( _M_AMD64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#include <emmintrin.h>
+#define SAFEVAR_CHACHA_SSE2 1
+#endif
+
 /**
  * @file    SafeVar.hpp
  * @brief   Secure variable wrapper and memory safety utilities for obfuscation and anti-cheat.
@@ -42,11 +51,10 @@ inline uint32_t LoadLE32 ( const uint8_t* src )
 
 }
 
-// Secure nonce generator
-void GenerateNonce ( std::array<uint8_t, 12>& nonceOut )
+// Wipe sensitive bytes in a way the optimizer is not allowed to elide
+inline void SecureWipe ( void* data, size_t len )
 {
-	std::random_device rd;
-	std::generate ( nonceOut.begin ( ), nonceOut.end ( ), std::ref ( rd ) );
+	SecureZeroMemory ( data, len );
 }
 
 // FNV-1a checksum
@@ -62,6 +70,228 @@ uint32_t ComputeChecksumFNV ( const uint8_t* data, size_t len )
 	return hash;
 }
 
+// SipHash-2-4 keyed hash (128-bit key, 64-bit output)
+inline uint64_t ComputeSipHash ( const uint8_t* key16, const uint8_t* data, size_t len )
+{
+	auto rotl = [ ] ( uint64_t x, int b ) { return ( x << b ) | ( x >> ( 64 - b ) ); };
+	auto load64 = [ ] ( const uint8_t* p ) { uint64_t v; std::memcpy ( &v, p, 8 ); return v; };
+
+	uint64_t k0 = load64 ( key16 ), k1 = load64 ( key16 + 8 );
+	uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+	uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+	uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+	uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+	auto round = [ & ] ( ) {
+		v0 += v1; v1 = rotl ( v1, 13 ); v1 ^= v0; v0 = rotl ( v0, 32 );
+		v2 += v3; v3 = rotl ( v3, 16 ); v3 ^= v2;
+		v0 += v3; v3 = rotl ( v3, 21 ); v3 ^= v0;
+		v2 += v1; v1 = rotl ( v1, 17 ); v1 ^= v2; v2 = rotl ( v2, 32 );
+	};
+
+	size_t blocks = len / 8;
+	for ( size_t i = 0; i < blocks; ++i ) {
+		uint64_t m = load64 ( data + i * 8 );
+		v3 ^= m; round ( ); round ( ); v0 ^= m;
+	}
+
+	uint64_t last = static_cast< uint64_t >( len & 0xFF ) << 56;
+	for ( size_t i = 0; i < ( len & 7 ); ++i ) {
+		last |= static_cast< uint64_t >( data [ blocks * 8 + i ] ) << ( 8 * i );
+	}
+	v3 ^= last; round ( ); round ( ); v0 ^= last;
+
+	v2 ^= 0xFF;
+	round ( ); round ( ); round ( ); round ( );
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Result of a non-throwing SafeVar integrity check
+enum class SafeVarStatus : uint8_t
+{
+	Ok = 0,
+	CanaryCorrupted,
+	InvalidMemory,
+	MemoryMismatch,
+	ChecksumMismatch,
+	BreakpointDetected,
+	ShadowMismatch,
+	VerificationFailed,
+	GenerationMismatch,
+	DecoyTampered
+};
+
+// Human readable description of a SafeVarStatus (matches the exception messages thrown by Get())
+inline const char* SafeVarStatusMessage ( SafeVarStatus status )
+{
+	switch ( status ) {
+	case SafeVarStatus::Ok:                 return "Ok";
+	case SafeVarStatus::CanaryCorrupted:    return "Buffer overflow/underrun detected";
+	case SafeVarStatus::InvalidMemory:      return "Invalid memory state";
+	case SafeVarStatus::MemoryMismatch:     return "Memory validation failed";
+	case SafeVarStatus::ChecksumMismatch:   return "Integrity check failed: possible memory freezing or tampering detected";
+	case SafeVarStatus::BreakpointDetected: return "Breakpoint detected in SafeVar::Get()";
+	case SafeVarStatus::ShadowMismatch:     return "Memory tampering detected: shadow copy mismatch";
+	case SafeVarStatus::VerificationFailed: return "Decryption verification failed";
+	case SafeVarStatus::GenerationMismatch: return "Write generation seal mismatch: possible memory freezing or rollback detected";
+	case SafeVarStatus::DecoyTampered:      return "Decoy value was modified: memory editing detected";
+	}
+	return "Unknown SafeVar status";
+}
+
+// One aggregated detection, as stored in the SafeTamperLog ring
+struct SafeTamperEvent
+{
+	SafeVarStatus status;
+	uintptr_t source;        // address of the SafeVar that detected the tampering
+	uint64_t tickMs;         // GetTickCount64 at detection
+};
+
+/**
+ * @brief Process-wide, lock-free, rate-limited ring of tamper detections.
+ *
+ * Detections are always counted per status. At most RateLimit() of them per second are also
+ * queued as events; the rest only bump Dropped(). A full ring drops new events instead of
+ * blocking. Consumers Drain() the ring from any thread, e.g. once per frame for reporting.
+ */
+class SafeTamperLog
+{
+public:
+	static constexpr size_t CAPACITY = 256;
+	static constexpr size_t STATUS_COUNT = static_cast< size_t >( SafeVarStatus::DecoyTampered ) + 1;
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence;
+		SafeTamperEvent event;
+	};
+
+	Slot slots [ CAPACITY ];
+	std::atomic<uint64_t> enqueuePos { 0 };
+	std::atomic<uint64_t> dequeuePos { 0 };
+
+	std::atomic<uint64_t> counts [ STATUS_COUNT ];
+	std::atomic<uint64_t> dropped { 0 };
+	std::atomic<uint32_t> rateLimit { 64 };
+	std::atomic<uint64_t> windowStart { 0 };
+	std::atomic<uint32_t> windowCount { 0 };
+
+	SafeTamperLog ( )
+	{
+		for ( size_t i = 0; i < CAPACITY; ++i ) slots [ i ].sequence.store ( i, std::memory_order_relaxed );
+		for ( auto& count : counts ) count.store ( 0, std::memory_order_relaxed );
+	}
+
+	bool Admit ( uint64_t now )
+	{
+		uint64_t start = windowStart.load ( std::memory_order_relaxed );
+		if ( now - start >= 1000 && windowStart.compare_exchange_strong ( start, now, std::memory_order_relaxed ) ) {
+			windowCount.store ( 0, std::memory_order_relaxed );
+		}
+		return windowCount.fetch_add ( 1, std::memory_order_relaxed ) < rateLimit.load ( std::memory_order_relaxed );
+	}
+
+	bool TryPush ( const SafeTamperEvent& event )
+	{
+		uint64_t pos = enqueuePos.load ( std::memory_order_relaxed );
+		for ( ;; ) {
+			Slot& slot = slots [ pos % CAPACITY ];
+			uint64_t seq = slot.sequence.load ( std::memory_order_acquire );
+			int64_t diff = static_cast< int64_t >( seq ) - static_cast< int64_t >( pos );
+			if ( diff == 0 ) {
+				if ( enqueuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) ) {
+					slot.event = event;
+					slot.sequence.store ( pos + 1, std::memory_order_release );
+					return true;
+				}
+			}
+			else if ( diff < 0 ) {
+				return false;
+			}
+			else {
+				pos = enqueuePos.load ( std::memory_order_relaxed );
+			}
+		}
+	}
+
+public:
+	SafeTamperLog ( const SafeTamperLog& ) = delete;
+	SafeTamperLog& operator=( const SafeTamperLog& ) = delete;
+
+	static SafeTamperLog& Instance ( )
+	{
+		static SafeTamperLog log;
+		return log;
+	}
+
+	// Never blocks and never allocates; safe to call from any detection site
+	void Report ( SafeVarStatus status, const void* source )
+	{
+		size_t index = static_cast< size_t >( status );
+		if ( index < STATUS_COUNT ) counts [ index ].fetch_add ( 1, std::memory_order_relaxed );
+
+		uint64_t now = GetTickCount64 ( );
+		if ( !Admit ( now ) || !TryPush ( { status, reinterpret_cast< uintptr_t >( source ), now } ) ) {
+			dropped.fetch_add ( 1, std::memory_order_relaxed );
+		}
+	}
+
+	bool TryPop ( SafeTamperEvent& out )
+	{
+		uint64_t pos = dequeuePos.load ( std::memory_order_relaxed );
+		for ( ;; ) {
+			Slot& slot = slots [ pos % CAPACITY ];
+			uint64_t seq = slot.sequence.load ( std::memory_order_acquire );
+			int64_t diff = static_cast< int64_t >( seq ) - static_cast< int64_t >( pos + 1 );
+			if ( diff == 0 ) {
+				if ( dequeuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) ) {
+					out = slot.event;
+					slot.sequence.store ( pos + CAPACITY, std::memory_order_release );
+					return true;
+				}
+			}
+			else if ( diff < 0 ) {
+				return false;
+			}
+			else {
+				pos = dequeuePos.load ( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	// Hand every queued event to visitor; returns how many were drained
+	template<typename Visitor>
+	size_t Drain ( Visitor&& visitor )
+	{
+		size_t drained = 0;
+		SafeTamperEvent event;
+		while ( TryPop ( event ) ) {
+			visitor ( event );
+			++drained;
+		}
+		return drained;
+	}
+
+	void SetRateLimit ( uint32_t eventsPerSecond ) { rateLimit.store ( eventsPerSecond, std::memory_order_relaxed ); }
+	uint32_t RateLimit ( ) const { return rateLimit.load ( std::memory_order_relaxed ); }
+
+	uint64_t Count ( SafeVarStatus status ) const
+	{
+		size_t index = static_cast< size_t >( status );
+		return index < STATUS_COUNT ? counts [ index ].load ( std::memory_order_relaxed ) : 0;
+	}
+
+	uint64_t Dropped ( ) const { return dropped.load ( std::memory_order_relaxed ); }
+};
+
+// What a quarantined SafeVar does with Set() calls
+enum class SafeQuarantineWrites : uint8_t
+{
+	Ignore,   // drop the write silently
+	Route     // drop the write and pass it to the type's quarantine write handler
+};
+
 class ChaCha20
 {
 public:
@@ -157,257 +387,1628 @@ public:
 		// !TODO : Add HMAC Processing
 		// Note: Add OpenSSL or Crypto++ for much more secure stuff.
 	}
+
+#ifdef SAFEVAR_CHACHA_SSE2
+	template<int N>
+	static __m128i RotateLeft4 ( __m128i x )
+	{
+		return _mm_or_si128 ( _mm_slli_epi32 ( x, N ), _mm_srli_epi32 ( x, 32 - N ) );
+	}
+
+	static void QuarterRound4 ( __m128i& a, __m128i& b, __m128i& c, __m128i& d )
+	{
+		a = _mm_add_epi32 ( a, b ); d = RotateLeft4<16> ( _mm_xor_si128 ( d, a ) );
+		c = _mm_add_epi32 ( c, d ); b = RotateLeft4<12> ( _mm_xor_si128 ( b, c ) );
+		a = _mm_add_epi32 ( a, b ); d = RotateLeft4<8> ( _mm_xor_si128 ( d, a ) );
+		c = _mm_add_epi32 ( c, d ); b = RotateLeft4<7> ( _mm_xor_si128 ( b, c ) );
+	}
+
+	// Four consecutive blocks at once: lane j of every state word belongs to block counter + j
+	static void Block4 ( const std::array<uint32_t, 16>& state, uint64_t counter, uint8_t* output )
+	{
+		__m128i input [ 16 ];
+		for ( int i = 0; i < 16; ++i ) {
+			input [ i ] = _mm_set1_epi32 ( static_cast< int >( state [ i ] ) );
+		}
+		uint64_t c0 = counter, c1 = counter + 1, c2 = counter + 2, c3 = counter + 3;
+		input [ 12 ] = _mm_setr_epi32 ( static_cast< int >( c0 ), static_cast< int >( c1 ), static_cast< int >( c2 ), static_cast< int >( c3 ) );
+		input [ 13 ] = _mm_setr_epi32 ( static_cast< int >( c0 >> 32 ), static_cast< int >( c1 >> 32 ), static_cast< int >( c2 >> 32 ), static_cast< int >( c3 >> 32 ) );
+		Rounds4 ( input, output );
+	}
+
+	// Runs the 20 rounds on four lane-interleaved states and writes block j to output + 64 * j
+	static void Rounds4 ( const __m128i* input, uint8_t* output )
+	{
+		__m128i x [ 16 ];
+		for ( int i = 0; i < 16; ++i ) x [ i ] = input [ i ];
+		for ( int i = 0; i < 20; i += 2 ) {
+			QuarterRound4 ( x [ 0 ], x [ 4 ], x [ 8 ], x [ 12 ] );
+			QuarterRound4 ( x [ 1 ], x [ 5 ], x [ 9 ], x [ 13 ] );
+			QuarterRound4 ( x [ 2 ], x [ 6 ], x [ 10 ], x [ 14 ] );
+			QuarterRound4 ( x [ 3 ], x [ 7 ], x [ 11 ], x [ 15 ] );
+
+			QuarterRound4 ( x [ 0 ], x [ 5 ], x [ 10 ], x [ 15 ] );
+			QuarterRound4 ( x [ 1 ], x [ 6 ], x [ 11 ], x [ 12 ] );
+			QuarterRound4 ( x [ 2 ], x [ 7 ], x [ 8 ], x [ 13 ] );
+			QuarterRound4 ( x [ 3 ], x [ 4 ], x [ 9 ], x [ 14 ] );
+		}
+
+		// Add the input and transpose 4x4 word groups back into per-block order
+		for ( int i = 0; i < 16; i += 4 ) {
+			__m128i a = _mm_add_epi32 ( x [ i ], input [ i ] );
+			__m128i b = _mm_add_epi32 ( x [ i + 1 ], input [ i + 1 ] );
+			__m128i c = _mm_add_epi32 ( x [ i + 2 ], input [ i + 2 ] );
+			__m128i d = _mm_add_epi32 ( x [ i + 3 ], input [ i + 3 ] );
+			__m128i ab0 = _mm_unpacklo_epi32 ( a, b ), cd0 = _mm_unpacklo_epi32 ( c, d );
+			__m128i ab1 = _mm_unpackhi_epi32 ( a, b ), cd1 = _mm_unpackhi_epi32 ( c, d );
+			_mm_storeu_si128 ( reinterpret_cast< __m128i* >( output + 0 * 64 + i * 4 ), _mm_unpacklo_epi64 ( ab0, cd0 ) );
+			_mm_storeu_si128 ( reinterpret_cast< __m128i* >( output + 1 * 64 + i * 4 ), _mm_unpackhi_epi64 ( ab0, cd0 ) );
+			_mm_storeu_si128 ( reinterpret_cast< __m128i* >( output + 2 * 64 + i * 4 ), _mm_unpacklo_epi64 ( ab1, cd1 ) );
+			_mm_storeu_si128 ( reinterpret_cast< __m128i* >( output + 3 * 64 + i * 4 ), _mm_unpackhi_epi64 ( ab1, cd1 ) );
+		}
+	}
+#endif
+
+	/**
+	 * One block at the same counter for four nonces under one key, written to output + 64 * j
+	 * for nonces[j]. Lets independent messages (e.g. a batch of sealed blobs) share one SIMD pass.
+	 */
+	static void KeystreamLanes ( const uint8_t* key, const uint8_t* const* nonces, uint64_t counter, uint8_t* output )
+	{
+#ifdef SAFEVAR_CHACHA_SSE2
+		__m128i input [ 16 ];
+		for ( int i = 0; i < 4; ++i ) {
+			input [ i ] = _mm_set1_epi32 ( static_cast< int >( constants [ i ] ) );
+		}
+		for ( int i = 0; i < 8; ++i ) {
+			input [ 4 + i ] = _mm_set1_epi32 ( static_cast< int >( LoadLE32 ( key + i * 4 ) ) );
+		}
+		input [ 12 ] = _mm_set1_epi32 ( static_cast< int >( counter ) );
+		input [ 13 ] = _mm_set1_epi32 ( static_cast< int >( counter >> 32 ) );
+		input [ 14 ] = _mm_setr_epi32 ( static_cast< int >( LoadLE32 ( nonces [ 0 ] ) ), static_cast< int >( LoadLE32 ( nonces [ 1 ] ) ),
+			static_cast< int >( LoadLE32 ( nonces [ 2 ] ) ), static_cast< int >( LoadLE32 ( nonces [ 3 ] ) ) );
+		input [ 15 ] = _mm_setr_epi32 ( static_cast< int >( LoadLE32 ( nonces [ 0 ] + 4 ) ), static_cast< int >( LoadLE32 ( nonces [ 1 ] + 4 ) ),
+			static_cast< int >( LoadLE32 ( nonces [ 2 ] + 4 ) ), static_cast< int >( LoadLE32 ( nonces [ 3 ] + 4 ) ) );
+		Rounds4 ( input, output );
+#else
+		for ( int j = 0; j < 4; ++j ) {
+			KeystreamBlocks ( key, nonces [ j ], counter, output + 64 * j, 1 );
+		}
+#endif
+	}
+
+	// Generate raw keystream: blocks consecutive 64-byte blocks starting at a 64-bit block counter.
+	// Block n equals the keystream Encrypt() XORs into bytes [64n, 64n + 64) under the same key/nonce.
+	// Runs four blocks per step with SSE2 where available.
+	static void KeystreamBlocks ( const uint8_t* key, const uint8_t* nonce, uint64_t counter, uint8_t* output, size_t blocks )
+	{
+		std::array<uint32_t, 16> state;
+		for ( int i = 0; i < 4; ++i ) {
+			state [ i ] = constants [ i ];
+		}
+		for ( int i = 0; i < 8; ++i ) {
+			state [ 4 + i ] = LoadLE32 ( key + i * 4 );
+		}
+		state [ 14 ] = LoadLE32 ( nonce + 0 );
+		state [ 15 ] = LoadLE32 ( nonce + 4 );
+
+		size_t b = 0;
+#ifdef SAFEVAR_CHACHA_SSE2
+		for ( ; b + 4 <= blocks; b += 4, counter += 4 ) {
+			Block4 ( state, counter, output + b * 64 );
+		}
+#endif
+		for ( ; b < blocks; ++b, ++counter ) {
+			state [ 12 ] = static_cast< uint32_t >( counter );
+			state [ 13 ] = static_cast< uint32_t >( counter >> 32 );
+			Block ( state, output + b * 64 );
+		}
+	}
 };
 
 /**
- * @brief RealMemoryAllocator and FakeMemoryAllocator for manipulating memory safely.
+ * @brief Source of all SafeVar randomness, with an optional deterministic mode.
  *
- * RealMemoryAllocator uses VirtualAlloc to allocate real memory. FakeMemoryAllocator uses
- * a simulated address space to fool cheaters.
+ * By default bytes come from std::random_device. SeedProcess() switches the process to a
+ * ChaCha20 stream derived from a seed. A Scope switches only the calling thread, for its
+ * lifetime, to a stream of its own derived from (seed, domain), e.g. one per simulation. Keys,
+ * nonces, masks and the keystream epochs all draw from the active source. A run that performs
+ * the same operations in the same order therefore produces bit-identical ciphertext, for
+ * reproducible benchmarks and lockstep replays. Fake addresses and the order of arena slots
+ * do not depend on randomness in any mode.
+ *
+ * Deterministic bytes are predictable to anyone who knows the seed, so this mode is for
+ * benchmarks, tests and replay tooling, not for protecting a shipped build. The process stream
+ * is shared: with several threads drawing from it, the interleaving decides who gets which
+ * bytes. Give each simulation thread a Scope when that matters.
+ *
+ * Process-wide secrets (SafeProcessHashKey) always come from FillFromSystem(), whichever mode
+ * is active when they are first used. A Scope suspends the thread's keystream and resumes it
+ * on exit, and epochs with identical seeded keys are shared, so a Scope per tick with the same
+ * seed does not grow the epoch table.
  */
-
- // Real Memory Allocator using Windows API
-class RealMemoryAllocator
+class SafeEntropy
 {
+	struct Stream
+	{
+		uint8_t key [ 32 ];
+		uint8_t nonce [ 8 ];
+		uint64_t counter = 0;
+		uint8_t block [ 64 ];
+		size_t used = 64;
+
+		Stream ( uint64_t seed, uint64_t domain )
+		{
+			static const uint8_t derivationNonce [ 8 ] = { 'S', 'a', 'f', 'e', 'S', 'e', 'e', 'd' };
+			uint8_t seedKey [ 32 ] = { };
+			std::memcpy ( seedKey, &seed, sizeof ( seed ) );
+			std::memcpy ( seedKey + 8, &domain, sizeof ( domain ) );
+
+			uint8_t derived [ 64 ];
+			ChaCha20::KeystreamBlocks ( seedKey, derivationNonce, 0, derived, 1 );
+			std::memcpy ( key, derived, sizeof ( key ) );
+			std::memcpy ( nonce, derived + 32, sizeof ( nonce ) );
+			SecureWipe ( derived, sizeof ( derived ) );
+		}
+
+		~Stream ( )
+		{
+			SecureWipe ( key, sizeof ( key ) );
+			SecureWipe ( block, sizeof ( block ) );
+		}
+
+		void Fill ( uint8_t* out, size_t len )
+		{
+			for ( size_t i = 0; i < len; ++i ) {
+				if ( used == 64 ) {
+					ChaCha20::KeystreamBlocks ( key, nonce, counter++, block, 1 );
+					used = 0;
+				}
+				out [ i ] = block [ used ];
+				block [ used++ ] = 0;
+			}
+		}
+	};
+
+	static std::mutex& ProcessMutex ( )
+	{
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	// Leaked on purpose so late static destructors can still draw bytes
+	static std::unique_ptr<Stream>*& ProcessStream ( )
+	{
+		static std::unique_ptr<Stream>* stream = new std::unique_ptr<Stream> ( );
+		return stream;
+	}
+
+	static std::atomic<bool>& ProcessSeeded ( )
+	{
+		static std::atomic<bool> seeded { false };
+		return seeded;
+	}
+
+	static Stream*& ThreadStream ( )
+	{
+		static thread_local Stream* stream = nullptr;
+		return stream;
+	}
+
+	// Where the calling thread's keystream stood before a Scope took it over
+	struct KeystreamState
+	{
+		uint32_t epoch;
+		uint64_t position;
+	};
+
+	// Implemented after SafeKeystream: starts a new keystream epoch for the calling thread
+	static void RestartThreadKeystream ( );
+	static KeystreamState SuspendThreadKeystream ( );
+	static void ResumeThreadKeystream ( const KeystreamState& state );
+
 public:
-	// Allocate real memory using VirtualAlloc
-	static void* AllocateRealMemory ( size_t size )
+	// Per-thread deterministic stream for one domain; scopes nest
+	class Scope
 	{
-		void* ptr = VirtualAlloc ( NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
-		if ( !ptr ) {
-			throw std::runtime_error ( "Memory allocation failed" );
+		Stream stream;
+		Stream* previous;
+		KeystreamState suspended;
+
+	public:
+		Scope ( uint64_t seed, uint64_t domain ) : stream ( seed, domain ), previous ( ThreadStream ( ) )
+		{
+			ThreadStream ( ) = &stream;
+			suspended = SuspendThreadKeystream ( );
 		}
-		return ptr;
+
+		~Scope ( )
+		{
+			ThreadStream ( ) = previous;
+			ResumeThreadKeystream ( suspended );
+		}
+
+		Scope ( const Scope& ) = delete;
+		Scope& operator=( const Scope& ) = delete;
+	};
+
+	// Derive all process randomness from seed; the calling thread also restarts its keystream
+	static void SeedProcess ( uint64_t seed )
+	{
+		{
+			std::lock_guard<std::mutex> lock ( ProcessMutex ( ) );
+			ProcessStream ( )->reset ( new Stream ( seed, 0 ) );
+			ProcessSeeded ( ).store ( true, std::memory_order_release );
+		}
+		RestartThreadKeystream ( );
 	}
 
-	// Free allocated memory using VirtualFree
-	static void FreeRealMemory ( void* ptr )
+	// Back to std::random_device
+	static void Unseed ( )
 	{
-		if ( !VirtualFree ( ptr, 0, MEM_RELEASE ) ) {
-			throw std::runtime_error ( "Memory free failed" );
+		{
+			std::lock_guard<std::mutex> lock ( ProcessMutex ( ) );
+			ProcessSeeded ( ).store ( false, std::memory_order_release );
+			ProcessStream ( )->reset ( );
+		}
+		RestartThreadKeystream ( );
+	}
+
+	// True when the calling thread draws deterministic bytes
+	static bool IsDeterministic ( )
+	{
+		return ThreadStream ( ) || ProcessSeeded ( ).load ( std::memory_order_acquire );
+	}
+
+	static void Fill ( uint8_t* out, size_t len )
+	{
+		if ( Stream* stream = ThreadStream ( ) ) {
+			stream->Fill ( out, len );
+			return;
+		}
+		if ( ProcessSeeded ( ).load ( std::memory_order_acquire ) ) {
+			std::lock_guard<std::mutex> lock ( ProcessMutex ( ) );
+			if ( Stream* stream = ProcessStream ( )->get ( ) ) {
+				stream->Fill ( out, len );
+				return;
+			}
+		}
+
+		FillFromSystem ( out, len );
+	}
+
+	// System randomness regardless of SeedProcess() and Scope, for secrets that outlive a run
+	static void FillFromSystem ( uint8_t* out, size_t len )
+	{
+		std::random_device rd;
+		for ( size_t i = 0; i < len; i += 4 ) {
+			uint32_t word = static_cast< uint32_t >( rd ( ) );
+			std::memcpy ( out + i, &word, std::min<size_t> ( 4, len - i ) );
 		}
 	}
 };
 
+// Secure nonce generator
+inline void GenerateNonce ( std::array<uint8_t, 12>& nonceOut )
+{
+	SafeEntropy::Fill ( nonceOut.data ( ), nonceOut.size ( ) );
+}
 
-// Fake Memory Allocator that simulates memory addresses
-class FakeMemoryAllocator
+// Fill a buffer with random bytes (keys for queues, arenas and other containers)
+inline void GenerateRandomBytes ( uint8_t* out, size_t len )
 {
-private:
-	static uintptr_t fakeBaseAddress;
-	static std::mutex mtx;
+	SafeEntropy::Fill ( out, len );
+}
 
+// Result of opening a sealed blob
+enum class SafeBlobStatus : uint8_t
+{
+	Ok,
+	Malformed,              // wrong length or magic
+	SizeMismatch,           // well-formed, but for a different value size
+	AuthenticationFailed,   // tag mismatch: forged, corrupted or sealed under another key
+	Rejected                // authentic, but refused by the caller's value check
+};
+
+inline const char* SafeBlobStatusMessage ( SafeBlobStatus status )
+{
+	switch ( status ) {
+	case SafeBlobStatus::Ok:                   return "Ok";
+	case SafeBlobStatus::Malformed:            return "Malformed sealed blob";
+	case SafeBlobStatus::SizeMismatch:         return "Sealed blob holds a value of a different size";
+	case SafeBlobStatus::AuthenticationFailed: return "Sealed blob authentication failed";
+	case SafeBlobStatus::Rejected:             return "Sealed blob value rejected";
+	}
+	return "Unknown sealed blob status";
+}
+
+/**
+ * @brief Authenticated wire format for SafeVar values.
+ *
+ * Layout: [magic "SVB1" u32][value size u32][nonce 8][ciphertext][tag u64], little-endian.
+ * Keystream block 0 of (key, nonce) supplies the 16-byte SipHash key, and the value is
+ * encrypted from block 1 on. The tag covers header and ciphertext (encrypt-then-MAC), so
+ * nothing is decrypted before the blob is authenticated. A nonce must never repeat under one key.
+ */
+class SafeSealedBlob
+{
 public:
-	// Allocate fake memory (simulated addresses)
-	static uintptr_t AllocateFakeMemory ( size_t size )
+	static constexpr uint32_t MAGIC = 0x31425653; // "SVB1"
+	static constexpr size_t HEADER_SIZE = 16;
+	static constexpr size_t NONCE_OFFSET = 8;
+	static constexpr size_t NONCE_SIZE = 8;
+	static constexpr size_t TAG_SIZE = 8;
+
+	static constexpr size_t SealedSize ( size_t valueSize ) { return HEADER_SIZE + valueSize + TAG_SIZE; }
+
+	// Tag over header and ciphertext; block0 is keystream block 0 of the blob's key and nonce
+	static uint64_t ComputeTag ( const uint8_t* block0, const uint8_t* blob, size_t valueSize )
 	{
-		std::lock_guard<std::mutex> lock ( mtx );
-		uintptr_t allocatedAddress = fakeBaseAddress;
-		fakeBaseAddress += size + 0x10;  // Increment to simulate allocation
-		return allocatedAddress;
+		return ComputeSipHash ( block0, blob, HEADER_SIZE + valueSize );
 	}
 
-	static void ResetAllocator ( )
+	static void WriteHeader ( uint8_t* out, size_t valueSize, const uint8_t* nonce )
 	{
-		fakeBaseAddress = 0x10000000;  // Reset fake memory space to initial state
+		uint32_t magic = MAGIC, size = static_cast< uint32_t >( valueSize );
+		std::memcpy ( out, &magic, sizeof ( magic ) );
+		std::memcpy ( out + 4, &size, sizeof ( size ) );
+		std::memcpy ( out + NONCE_OFFSET, nonce, NONCE_SIZE );
 	}
-};
 
-uintptr_t FakeMemoryAllocator::fakeBaseAddress = 0x10000000;  // Starting fake memory address
-std::mutex FakeMemoryAllocator::mtx;  // Mutex to protect fake memory allocation
+	// Framing check shared by Open() and the batch validators
+	static SafeBlobStatus CheckFraming ( const uint8_t* blob, size_t blobLen, size_t valueSize )
+	{
+		if ( blobLen < SealedSize ( 0 ) ) return SafeBlobStatus::Malformed;
+		uint32_t magic, size;
+		std::memcpy ( &magic, blob, sizeof ( magic ) );
+		std::memcpy ( &size, blob + 4, sizeof ( size ) );
+		if ( magic != MAGIC || blobLen != SealedSize ( size ) ) return SafeBlobStatus::Malformed;
+		if ( size != valueSize ) return SafeBlobStatus::SizeMismatch;
+		return SafeBlobStatus::Ok;
+	}
 
-class MemoryPool
-{
-private:
-	std::vector<void*> freeBlocks; // Holds free blocks of memory
-	std::mutex mtx; // Mutex for thread safety
+	static bool TagMatches ( const uint8_t* block0, const uint8_t* blob, size_t valueSize )
+	{
+		uint64_t expected = ComputeTag ( block0, blob, valueSize ), actual;
+		std::memcpy ( &actual, blob + HEADER_SIZE + valueSize, TAG_SIZE );
+		return ( expected ^ actual ) == 0;
+	}
 
-public:
-	void* Allocate ( size_t size )
+	// XOR len bytes with the keystream from block 1 on; the first block may be passed in precomputed
+	static void ApplyPayload ( const uint8_t* key, const uint8_t* nonce, const uint8_t* in, uint8_t* out, size_t len, const uint8_t* block1 = nullptr )
 	{
-		std::lock_guard<std::mutex> lock ( mtx );
-		if ( !freeBlocks.empty ( ) ) {
-			void* ptr = freeBlocks.back ( );
-			freeBlocks.pop_back ( );
-			return ptr;
+		uint8_t stream [ 64 ];
+		for ( size_t offset = 0; offset < len; offset += 64 ) {
+			const uint8_t* block = block1;
+			if ( offset || !block ) {
+				ChaCha20::KeystreamBlocks ( key, nonce, 1 + offset / 64, stream, 1 );
+				block = stream;
+			}
+			size_t chunk = len - offset < 64 ? len - offset : 64;
+			for ( size_t i = 0; i < chunk; ++i ) {
+				out [ offset + i ] = in [ offset + i ] ^ block [ i ];
+			}
 		}
-		return RealMemoryAllocator::AllocateRealMemory ( size ); // Fall back to system allocator
+		SecureWipe ( stream, sizeof ( stream ) );
 	}
 
-	void Free ( void* ptr )
+	// Seal valueSize bytes of plaintext into out (SealedSize(valueSize) bytes)
+	static void Seal ( const uint8_t* key, const uint8_t* nonce, const uint8_t* plain, size_t valueSize, uint8_t* out )
 	{
-		std::lock_guard<std::mutex> lock ( mtx );
-		freeBlocks.push_back ( ptr ); // Return to pool for reuse
+		WriteHeader ( out, valueSize, nonce );
+		ApplyPayload ( key, nonce, plain, out + HEADER_SIZE, valueSize );
+
+		uint8_t block0 [ 64 ];
+		ChaCha20::KeystreamBlocks ( key, nonce, 0, block0, 1 );
+		uint64_t tag = ComputeTag ( block0, out, valueSize );
+		std::memcpy ( out + HEADER_SIZE + valueSize, &tag, TAG_SIZE );
+		SecureWipe ( block0, sizeof ( block0 ) );
 	}
 
-	~MemoryPool ( )
+	// Check framing and tag, then decrypt into plainOut (valueSize bytes). plainOut is only written on Ok.
+	static SafeBlobStatus Open ( const uint8_t* key, const uint8_t* blob, size_t blobLen, uint8_t* plainOut, size_t valueSize )
 	{
-		for ( auto ptr : freeBlocks ) {
-			RealMemoryAllocator::FreeRealMemory ( ptr );
-		}
+		SafeBlobStatus status = CheckFraming ( blob, blobLen, valueSize );
+		if ( status != SafeBlobStatus::Ok ) return status;
+
+		const uint8_t* nonce = blob + NONCE_OFFSET;
+		uint8_t block0 [ 64 ];
+		ChaCha20::KeystreamBlocks ( key, nonce, 0, block0, 1 );
+		bool authentic = TagMatches ( block0, blob, valueSize );
+		SecureWipe ( block0, sizeof ( block0 ) );
+		if ( !authentic ) return SafeBlobStatus::AuthenticationFailed;
+
+		ApplyPayload ( key, nonce, blob + HEADER_SIZE, plainOut, valueSize );
+		return SafeBlobStatus::Ok;
 	}
 };
 
-// SafeVar class for secure variable handling with obfuscation and memory manipulation
-template<typename T>
-class SafeVar
+/**
+ * @brief Per-thread keystream cache for SafeVar encryption.
+ *
+ * Every thread owns an epoch: a random ChaCha20 key and nonce. Epochs live in a process-wide
+ * table and are never freed, so values written by a thread stay readable after it exits.
+ * Only explicitly retired epochs (SafeKeyDomain) give their ids back for reuse.
+ * The thread generates BATCH_BLOCKS keystream blocks at a time and hands out consecutive,
+ * never reused slices of them. A SafeVar records only (epoch, byte position) per buffer
+ * instead of a key and nonce; a 4-byte write consumes 4 bytes of a 64-byte block.
+ *
+ * Decryption regenerates the slice, served from the thread's current batch or a one-block
+ * cache when possible.
+ */
+class SafeKeystream
 {
-	static_assert( std::is_trivially_copyable<T>::value&& std::is_default_constructible<T>::value,
-		"SafeVar<T> requires trivially copyable and default-constructible types." );
+public:
+	static constexpr size_t BATCH_BLOCKS = 16;
+	static constexpr size_t BATCH_BYTES = BATCH_BLOCKS * 64;
 
 private:
-	static MemoryPool memoryPool;
-	static constexpr size_t VALUE_SIZE = sizeof ( T );
+	struct Epoch
+	{
+		uint8_t key [ 32 ];
+		uint8_t nonce [ 8 ];
+		uint32_t generation;             // bumped on every reuse of the id
+	};
+
+	// Ids of retired epochs, handed out again before the table grows
+	struct FreeList
+	{
+		std::mutex mtx;
+		std::vector<uint32_t> ids;
+	};
+
+	static constexpr size_t EPOCHS_PER_CHUNK = 1024;
+	static constexpr size_t MAX_CHUNKS = 1024;
+	static constexpr uint32_t NO_EPOCH = ~0u;
+
+	uint32_t epoch = NO_EPOCH;           // registered on the thread's first write
+	uint64_t position = 0;               // next unissued byte of this thread's stream
+	uint64_t batchStart = 0;             // stream offset of batch[0]
+	uint64_t batchEnd = 0;
+	alignas( 16 ) uint8_t batch [ BATCH_BYTES ];
+
+	// One-block cache for slices outside the batch (other threads' epochs, older writes)
+	uint32_t cachedEpoch = NO_EPOCH;
+	uint32_t cachedGeneration = 0;
+	uint64_t cachedBlock = ~0ULL;
+	alignas( 16 ) uint8_t cached [ 64 ];
+
+	static std::atomic<Epoch*>* Chunks ( )
+	{
+		static std::atomic<Epoch*> chunks [ MAX_CHUNKS ];
+		return chunks;
+	}
+
+	static const Epoch& EpochAt ( uint32_t id )
+	{
+		return Chunks ( ) [ id / EPOCHS_PER_CHUNK ].load ( std::memory_order_acquire ) [ id % EPOCHS_PER_CHUNK ];
+	}
+
+	static FreeList& FreeIds ( )
+	{
+		static FreeList freeIds;
+		return freeIds;
+	}
+
+	// Thread epoch keyed from the entropy source active at registration (see SafeEntropy)
+	static uint32_t RegisterEpoch ( )
+	{
+		uint8_t key [ 32 ], nonce [ 8 ];
+		GenerateRandomBytes ( key, sizeof ( key ) );
+		GenerateRandomBytes ( nonce, sizeof ( nonce ) );
+		uint32_t id = SafeEntropy::IsDeterministic ( ) ? SeededEpoch ( key, nonce ) : RegisterEpoch ( key, nonce );
+		SecureWipe ( key, sizeof ( key ) );
+		return id;
+	}
+
+	// Seeded scopes re-derive the same key every time they run. Such epochs are shared instead
+	// of registered again: same key, same positions, so the ciphertext is what a new epoch gives.
+	static uint32_t SeededEpoch ( const uint8_t* key, const uint8_t* nonce )
+	{
+		static std::mutex seededMtx;
+		static auto* byPrefix = new std::unordered_multimap<uint64_t, uint32_t> ( );   // leaked like the epochs
+
+		uint64_t prefix;
+		std::memcpy ( &prefix, key, sizeof ( prefix ) );
+
+		std::lock_guard<std::mutex> lock ( seededMtx );
+		auto range = byPrefix->equal_range ( prefix );
+		for ( auto it = range.first; it != range.second; ++it ) {
+			const Epoch& e = EpochAt ( it->second );
+			if ( std::memcmp ( e.key, key, sizeof ( e.key ) ) == 0 && std::memcmp ( e.nonce, nonce, sizeof ( e.nonce ) ) == 0 ) {
+				return it->second;
+			}
+		}
+		uint32_t id = RegisterEpoch ( key, nonce );
+		byPrefix->emplace ( prefix, id );
+		return id;
+	}
+
+	SafeKeystream ( ) = default;
+
+	~SafeKeystream ( )
+	{
+		SecureWipe ( batch, sizeof ( batch ) );
+		SecureWipe ( cached, sizeof ( cached ) );
+	}
+
+	static SafeKeystream& Local ( )
+	{
+		static thread_local SafeKeystream cache;
+		return cache;
+	}
+
+	void Refill ( )
+	{
+		batchStart = ( position + 63 ) & ~63ULL;
+		const Epoch& e = EpochAt ( epoch );
+		ChaCha20::KeystreamBlocks ( e.key, e.nonce, batchStart / 64, batch, BATCH_BLOCKS );
+		batchEnd = batchStart + BATCH_BYTES;
+		position = batchStart;
+	}
+
+	// XOR keystream bytes [pos, pos + len) of epochId into data
+	void Xor ( uint32_t epochId, uint64_t pos, const uint8_t* in, uint8_t* out, size_t len )
+	{
+		if ( epochId == epoch && pos >= batchStart && pos + len <= batchEnd ) {
+			const uint8_t* ks = batch + ( pos - batchStart );
+			for ( size_t i = 0; i < len; ++i ) out [ i ] = in [ i ] ^ ks [ i ];
+			return;
+		}
+
+		const Epoch& e = EpochAt ( epochId );
+		for ( size_t i = 0; i < len; ) {
+			uint64_t block = ( pos + i ) / 64;
+			// The generation tells a reused id apart from the retired epoch the block was cached for
+			if ( block != cachedBlock || epochId != cachedEpoch || e.generation != cachedGeneration ) {
+				ChaCha20::KeystreamBlocks ( e.key, e.nonce, block, cached, 1 );
+				cachedBlock = block;
+				cachedEpoch = epochId;
+				cachedGeneration = e.generation;
+			}
+			size_t offset = static_cast< size_t >( ( pos + i ) % 64 );
+			size_t run = std::min<size_t> ( 64 - offset, len - i );
+			for ( size_t j = 0; j < run; ++j ) out [ i + j ] = in [ i + j ] ^ cached [ offset + j ];
+			i += run;
+		}
+	}
+
+public:
+	SafeKeystream ( const SafeKeystream& ) = delete;
+	SafeKeystream& operator=( const SafeKeystream& ) = delete;
+
+	// Register an epoch under a caller-derived key (SafeKeyDomain). Slices are read with Apply().
+	// Retired ids are reused first; the table only throws once every id is live.
+	static uint32_t RegisterEpoch ( const uint8_t* key, const uint8_t* nonce )
+	{
+		static std::atomic<uint32_t> next { 0 };
+		static std::mutex growMtx;
+
+		{
+			FreeList& freeIds = FreeIds ( );
+			std::lock_guard<std::mutex> lock ( freeIds.mtx );
+			if ( !freeIds.ids.empty ( ) ) {
+				uint32_t id = freeIds.ids.back ( );
+				freeIds.ids.pop_back ( );
+				Epoch& e = const_cast< Epoch& >( EpochAt ( id ) );
+				std::memcpy ( e.key, key, sizeof ( e.key ) );
+				std::memcpy ( e.nonce, nonce, sizeof ( e.nonce ) );
+				++e.generation;
+				std::atomic_thread_fence ( std::memory_order_release );
+				return id;
+			}
+		}
+
+		uint32_t id = next.fetch_add ( 1, std::memory_order_relaxed );
+		if ( id >= EPOCHS_PER_CHUNK * MAX_CHUNKS ) {
+			throw std::runtime_error ( "SafeKeystream: epoch table exhausted" );
+		}
+
+		std::atomic<Epoch*>& chunk = Chunks ( ) [ id / EPOCHS_PER_CHUNK ];
+		if ( !chunk.load ( std::memory_order_acquire ) ) {
+			std::lock_guard<std::mutex> lock ( growMtx );
+			if ( !chunk.load ( std::memory_order_relaxed ) ) {
+				chunk.store ( new Epoch [ EPOCHS_PER_CHUNK ] ( ), std::memory_order_release );
+			}
+		}
+
+		// Published before any slice of this epoch is handed out
+		Epoch& e = const_cast< Epoch& >( EpochAt ( id ) );
+		std::memcpy ( e.key, key, sizeof ( e.key ) );
+		std::memcpy ( e.nonce, nonce, sizeof ( e.nonce ) );
+		std::atomic_thread_fence ( std::memory_order_release );
+		return id;
+	}
+
+	/**
+	 * Wipe an epoch's key, so every slice issued under it decrypts to noise from now on, and
+	 * give the id back for reuse. Reuse is safe: the old slices are already unreadable, and the
+	 * epoch's generation changes, so no thread serves a block cached under the old key. No other
+	 * thread may use the epoch concurrently; their one-block caches can still hold one keystream
+	 * block of it, but no plaintext.
+	 */
+	static void RetireEpoch ( uint32_t id )
+	{
+		Epoch& e = const_cast< Epoch& >( EpochAt ( id ) );
+		SecureWipe ( e.key, sizeof ( e.key ) );
+		SecureWipe ( e.nonce, sizeof ( e.nonce ) );
+
+		SafeKeystream& local = Local ( );
+		if ( local.cachedEpoch == id ) {
+			SecureWipe ( local.cached, sizeof ( local.cached ) );
+			local.cachedEpoch = NO_EPOCH;
+			local.cachedBlock = ~0ULL;
+		}
+
+		FreeList& freeIds = FreeIds ( );
+		std::lock_guard<std::mutex> lock ( freeIds.mtx );
+		freeIds.ids.push_back ( id );
+	}
+
+	// Encrypt len bytes under a fresh slice of the calling thread's stream
+	static void Encrypt ( const uint8_t* in, uint8_t* out, size_t len, uint32_t& epochOut, uint64_t& positionOut )
+	{
+		SafeKeystream& local = Local ( );
+		if ( local.epoch == NO_EPOCH ) {
+			local.epoch = RegisterEpoch ( );
+		}
+		if ( local.position + len > local.batchEnd && len <= BATCH_BYTES ) {
+			local.Refill ( );
+		}
+		epochOut = local.epoch;
+		positionOut = local.position;
+		local.position += len;
+		local.Xor ( epochOut, positionOut, in, out, len );
+	}
+
+	// Decrypt (or re-encrypt) with a previously issued slice; callable from any thread
+	static void Apply ( uint32_t epochId, uint64_t pos, const uint8_t* in, uint8_t* out, size_t len )
+	{
+		Local ( ).Xor ( epochId, pos, in, out, len );
+	}
+
+	// The calling thread's next write starts a new epoch keyed from the entropy source active
+	// at that time. Slices issued under the old epoch stay readable.
+	static void Restart ( )
+	{
+		Resume ( NO_EPOCH, 0 );
+	}
+
+	// Continue the calling thread's stream at (epochId, pos), e.g. after a SafeEntropy::Scope.
+	// pos must not precede any slice the thread already issued under epochId.
+	static void Resume ( uint32_t epochId, uint64_t pos )
+	{
+		SafeKeystream& local = Local ( );
+		SecureWipe ( local.batch, sizeof ( local.batch ) );
+		local.epoch = epochId;
+		local.position = pos;
+		local.batchStart = 0;
+		local.batchEnd = 0;
+	}
+
+	static uint32_t CurrentEpoch ( ) { return Local ( ).epoch; }
+	static uint64_t CurrentPosition ( ) { return Local ( ).position; }
+};
+
+inline void SafeEntropy::RestartThreadKeystream ( )
+{
+	SafeKeystream::Restart ( );
+}
+
+inline SafeEntropy::KeystreamState SafeEntropy::SuspendThreadKeystream ( )
+{
+	KeystreamState state = { SafeKeystream::CurrentEpoch ( ), SafeKeystream::CurrentPosition ( ) };
+	SafeKeystream::Restart ( );
+	return state;
+}
+
+inline void SafeEntropy::ResumeThreadKeystream ( const KeystreamState& state )
+{
+	SafeKeystream::Resume ( state.epoch, state.position );
+}
+
+/**
+ * @brief Keystream shared by the SafeVars of one SafeDomain (see SafeDomain.hpp).
+ *
+ * Owns a single epoch under a key derived by the domain and issues slices from an atomic
+ * counter instead of per-thread batches. Retire() wipes the epoch key, so everything the
+ * domain ever encrypted becomes unreadable in one step, however many variables it holds.
+ */
+class SafeKeyDomain
+{
+private:
+	uint32_t epoch;
+	std::atomic<uint64_t> position { 0 };
+	bool retired = false;
+
+public:
+	SafeKeyDomain ( const uint8_t* key, const uint8_t* nonce ) : epoch ( SafeKeystream::RegisterEpoch ( key, nonce ) ) { }
+	SafeKeyDomain ( const SafeKeyDomain& ) = delete;
+	SafeKeyDomain& operator=( const SafeKeyDomain& ) = delete;
+
+	void Encrypt ( const uint8_t* in, uint8_t* out, size_t len, uint32_t& epochOut, uint64_t& positionOut )
+	{
+		epochOut = epoch;
+		positionOut = position.fetch_add ( len, std::memory_order_relaxed );
+		SafeKeystream::Apply ( epoch, positionOut, in, out, len );
+	}
+
+	// Idempotent: a second retire must not hand the id out twice
+	void Retire ( )
+	{
+		if ( retired ) return;
+		retired = true;
+		SafeKeystream::RetireEpoch ( epoch );
+	}
+};
+
+/**
+ * @brief RealMemoryAllocator and FakeMemoryAllocator for manipulating memory safely.
+ *
+ * RealMemoryAllocator uses VirtualAlloc to allocate real memory. FakeMemoryAllocator uses
+ * a simulated address space to fool cheaters.
+ */
+
+ // Real Memory Allocator using Windows API
+class RealMemoryAllocator
+{
+public:
+	// Allocate real memory using VirtualAlloc
+	static void* AllocateRealMemory ( size_t size )
+	{
+		void* ptr = VirtualAlloc ( NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+		if ( !ptr ) {
+			throw std::runtime_error ( "Memory allocation failed" );
+		}
+		return ptr;
+	}
+
+	// Free allocated memory using VirtualFree
+	static void FreeRealMemory ( void* ptr )
+	{
+		if ( !VirtualFree ( ptr, 0, MEM_RELEASE ) ) {
+			throw std::runtime_error ( "Memory free failed" );
+		}
+	}
+};
+
+
+/**
+ * @brief Process-wide store of precomputed keystream pads, one instance per slot size.
+ *
+ * Pads live in their own VirtualAlloc'd chunks, away from the SafeVar objects and their real
+ * memory, so a dump of either region alone reveals nothing. Slots are addressed by index;
+ * Slot() bounds-checks the index, so a corrupted index cannot redirect a read elsewhere.
+ */
+template<size_t SLOT_SIZE>
+class SafePadStore
+{
+	static constexpr size_t CHUNK_BYTES = 64 * 1024;
+	static constexpr size_t SLOTS_PER_CHUNK = SLOT_SIZE < CHUNK_BYTES ? CHUNK_BYTES / SLOT_SIZE : 1;
+	static constexpr size_t MAX_CHUNKS = 4096;
+
+	std::atomic<uint8_t*> chunks [ MAX_CHUNKS ];
+	std::atomic<uint32_t> capacity { 0 };
+	std::vector<uint32_t> freeSlots;
+	std::mutex mtx;
+
+	SafePadStore ( )
+	{
+		for ( auto& chunk : chunks ) chunk.store ( nullptr, std::memory_order_relaxed );
+	}
+
+public:
+	static constexpr uint32_t NO_SLOT = ~0u;
+
+	SafePadStore ( const SafePadStore& ) = delete;
+	SafePadStore& operator=( const SafePadStore& ) = delete;
+
+	// Leaked on purpose: pads may be released by SafeVars destroyed during static teardown
+	static SafePadStore& Instance ( )
+	{
+		static SafePadStore* store = new SafePadStore ( );
+		return *store;
+	}
+
+	uint32_t Acquire ( )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( !freeSlots.empty ( ) ) {
+			uint32_t index = freeSlots.back ( );
+			freeSlots.pop_back ( );
+			return index;
+		}
+
+		uint32_t index = capacity.load ( std::memory_order_relaxed );
+		size_t chunk = index / SLOTS_PER_CHUNK;
+		if ( chunk >= MAX_CHUNKS ) {
+			throw std::runtime_error ( "SafePadStore: pad store exhausted" );
+		}
+		if ( !chunks [ chunk ].load ( std::memory_order_relaxed ) ) {
+			chunks [ chunk ].store ( static_cast< uint8_t* >( RealMemoryAllocator::AllocateRealMemory ( SLOTS_PER_CHUNK * SLOT_SIZE ) ), std::memory_order_release );
+		}
+		capacity.store ( index + 1, std::memory_order_release );
+		return index;
+	}
+
+	void Release ( uint32_t index )
+	{
+		uint8_t* slot = Slot ( index );
+		if ( !slot ) return;
+		SecureWipe ( slot, SLOT_SIZE );
+		std::lock_guard<std::mutex> lock ( mtx );
+		freeSlots.push_back ( index );
+	}
+
+	// nullptr for indices that were never handed out
+	uint8_t* Slot ( uint32_t index ) const
+	{
+		if ( index >= capacity.load ( std::memory_order_acquire ) ) return nullptr;
+		return chunks [ index / SLOTS_PER_CHUNK ].load ( std::memory_order_acquire ) + ( index % SLOTS_PER_CHUNK ) * SLOT_SIZE;
+	}
+};
+
+/**
+ * @brief Slab arena for SafeVar real memory, with optional batched page protection.
+ *
+ * Values up to MAX_SLOT_SIZE bytes get a slot in 64 KB chunks instead of a VirtualAlloc of
+ * their own per write. Free slots are reused in FIFO order, so a variable's real address
+ * keeps moving between writes. Larger values still use RealMemoryAllocator.
+ *
+ * With batched protection enabled, the chunks are PAGE_NOACCESS while the arena is closed.
+ * The first SafeVar operation after a close opens all chunks with one VirtualProtect each,
+ * and EndFrame() closes them again. Protection then costs two VirtualProtect calls per chunk
+ * per frame, not one per access. Call EndFrame() at a frame boundary, when no other thread is
+ * using SafeVars. Windows has no user-mode memory protection keys, so this batched mode is
+ * the cheap toggle available here.
+ */
+class SafeArena
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+	static constexpr size_t SLOT_ALIGN = 16;
+	static constexpr size_t MAX_SLOT_SIZE = 256;
+
+private:
+	static constexpr size_t CLASSES = MAX_SLOT_SIZE / SLOT_ALIGN;
+
+	struct SizeClass
+	{
+		std::deque<uint8_t*> freeSlots;
+		uint8_t* bump = nullptr;         // next unused slot of the newest chunk
+		uint8_t* bumpEnd = nullptr;
+	};
+
+	SizeClass classes [ CLASSES ];
+	std::vector<uint8_t*> chunks;
+	std::mutex mtx;
+	std::atomic<bool> batched { false };
+	std::atomic<bool> open { true };
+	std::atomic<uint64_t> protectCalls { 0 };
+
+	// Caller holds mtx
+	void ProtectAll ( DWORD protection )
+	{
+		for ( uint8_t* chunk : chunks ) {
+			DWORD previous;
+			if ( !VirtualProtect ( chunk, CHUNK_SIZE, protection, &previous ) ) {
+				throw std::runtime_error ( "SafeArena: VirtualProtect failed" );
+			}
+		}
+		protectCalls.fetch_add ( chunks.size ( ), std::memory_order_relaxed );
+	}
+
+public:
+	SafeArena ( ) = default;
+	SafeArena ( const SafeArena& ) = delete;
+	SafeArena& operator=( const SafeArena& ) = delete;
+
+	// Arenas other than Instance() belong to a SafeDomain and outlive all of its variables
+	~SafeArena ( ) { Release ( ); }
+
+	// Leaked on purpose: slots may be freed by SafeVars destroyed during static teardown
+	static SafeArena& Instance ( )
+	{
+		static SafeArena* arena = new SafeArena ( );
+		return *arena;
+	}
+
+	static bool Fits ( size_t size ) { return size <= MAX_SLOT_SIZE; }
+
+	void* Allocate ( size_t size )
+	{
+		if ( !Fits ( size ) ) return RealMemoryAllocator::AllocateRealMemory ( size );
+
+		size_t index = ( size + SLOT_ALIGN - 1 ) / SLOT_ALIGN - 1;
+		size_t stride = ( index + 1 ) * SLOT_ALIGN;
+		SizeClass& sizeClass = classes [ index ];
+
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( !sizeClass.freeSlots.empty ( ) ) {
+			uint8_t* slot = sizeClass.freeSlots.front ( );
+			sizeClass.freeSlots.pop_front ( );
+			return slot;
+		}
+		if ( !sizeClass.bump || sizeClass.bump + stride > sizeClass.bumpEnd ) {
+			uint8_t* chunk = static_cast< uint8_t* >( RealMemoryAllocator::AllocateRealMemory ( CHUNK_SIZE ) );
+			chunks.push_back ( chunk );
+			sizeClass.bump = chunk;
+			sizeClass.bumpEnd = chunk + CHUNK_SIZE;
+		}
+		uint8_t* slot = sizeClass.bump;
+		sizeClass.bump += stride;
+		return slot;
+	}
+
+	void Free ( void* ptr, size_t size )
+	{
+		if ( !Fits ( size ) ) {
+			RealMemoryAllocator::FreeRealMemory ( ptr );
+			return;
+		}
+		size_t index = ( size + SLOT_ALIGN - 1 ) / SLOT_ALIGN - 1;
+		std::lock_guard<std::mutex> lock ( mtx );
+		classes [ index ].freeSlots.push_back ( static_cast< uint8_t* >( ptr ) );
+	}
+
+	// Return every chunk to the system at once; all slots handed out so far become invalid
+	void Release ( )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		for ( uint8_t* chunk : chunks ) {
+			RealMemoryAllocator::FreeRealMemory ( chunk );
+		}
+		chunks.clear ( );
+		for ( SizeClass& sizeClass : classes ) {
+			sizeClass.freeSlots.clear ( );
+			sizeClass.bump = nullptr;
+			sizeClass.bumpEnd = nullptr;
+		}
+		open.store ( true, std::memory_order_release );
+	}
+
+	// Hot-path guard used by SafeVar before it touches real memory: one acquire load when open
+	void EnsureOpen ( )
+	{
+		if ( !open.load ( std::memory_order_acquire ) ) {
+			std::lock_guard<std::mutex> lock ( mtx );
+			if ( !open.load ( std::memory_order_relaxed ) ) {
+				ProtectAll ( PAGE_READWRITE );
+				open.store ( true, std::memory_order_release );
+			}
+		}
+	}
+
+	// Close the arena until the next SafeVar operation (no-op unless batched protection is on)
+	void EndFrame ( )
+	{
+		if ( !batched.load ( std::memory_order_relaxed ) ) return;
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( open.load ( std::memory_order_relaxed ) ) {
+			ProtectAll ( PAGE_NOACCESS );
+			open.store ( false, std::memory_order_release );
+		}
+	}
+
+	void SetBatchedProtection ( bool enable )
+	{
+		batched.store ( enable, std::memory_order_relaxed );
+		if ( !enable ) EnsureOpen ( );
+	}
+
+	bool BatchedProtection ( ) const { return batched.load ( std::memory_order_relaxed ); }
+	bool IsOpen ( ) const { return open.load ( std::memory_order_acquire ); }
+	uint64_t ProtectCalls ( ) const { return protectCalls.load ( std::memory_order_relaxed ); }
+
+	size_t ChunkCount ( )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		return chunks.size ( );
+	}
+};
+
+// Fake Memory Allocator that simulates memory addresses
+class FakeMemoryAllocator
+{
+private:
+	static uintptr_t fakeBaseAddress;
+	static std::mutex mtx;
+
+public:
+	// Allocate fake memory (simulated addresses)
+	static uintptr_t AllocateFakeMemory ( size_t size )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		uintptr_t allocatedAddress = fakeBaseAddress;
+		fakeBaseAddress += size + 0x10;  // Increment to simulate allocation
+		return allocatedAddress;
+	}
+
+	static void ResetAllocator ( )
+	{
+		fakeBaseAddress = 0x10000000;  // Reset fake memory space to initial state
+	}
+};
+
+uintptr_t FakeMemoryAllocator::fakeBaseAddress = 0x10000000;  // Starting fake memory address
+std::mutex FakeMemoryAllocator::mtx;  // Mutex to protect fake memory allocation
+
+class MemoryPool
+{
+private:
+	std::vector<void*> freeBlocks; // Holds free blocks of memory
+	std::mutex mtx; // Mutex for thread safety
+
+public:
+	void* Allocate ( size_t size )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		if ( !freeBlocks.empty ( ) ) {
+			void* ptr = freeBlocks.back ( );
+			freeBlocks.pop_back ( );
+			return ptr;
+		}
+		return RealMemoryAllocator::AllocateRealMemory ( size ); // Fall back to system allocator
+	}
+
+	void Free ( void* ptr )
+	{
+		std::lock_guard<std::mutex> lock ( mtx );
+		freeBlocks.push_back ( ptr ); // Return to pool for reuse
+	}
+
+	~MemoryPool ( )
+	{
+		for ( auto ptr : freeBlocks ) {
+			RealMemoryAllocator::FreeRealMemory ( ptr );
+		}
+	}
+};
+
+// Process-wide 128-bit secret for keyed value tags. Never leaves the process.
+inline const std::array<uint8_t, 16>& SafeProcessHashKey ( )
+{
+	static const std::array<uint8_t, 16> secret = [ ] {
+		std::array<uint8_t, 16> k;
+		SafeEntropy::FillFromSystem ( k.data ( ), k.size ( ) );
+		return k;
+	}( );
+	return secret;
+}
+
+/**
+ * @brief Incremental keyed hash over the plaintext of many SafeVars.
+ *
+ * The digest is the sum (mod 2^64) of SipHash(sessionKey, id || value) over every attached
+ * variable, so a write only swaps one term: O(1) per Set() and no decryption to compare
+ * state. Peers that share the session key and the variable ids produce equal digests for
+ * equal state regardless of each side's in-memory keys. Values should be free of padding
+ * bytes when digests are compared across processes.
+ */
+class SafeStateHash
+{
+private:
+	std::array<uint8_t, 16> sessionKey;
+	std::atomic<uint64_t> digest { 0 };
+
+public:
+	explicit SafeStateHash ( const std::array<uint8_t, 16>& key ) : sessionKey ( key ) { }
+	SafeStateHash ( const SafeStateHash& ) = delete;
+	SafeStateHash& operator=( const SafeStateHash& ) = delete;
+	~SafeStateHash ( ) { SecureWipe ( sessionKey.data ( ), sessionKey.size ( ) ); }
+
+	uint64_t Contribution ( uint64_t id, const void* value, size_t len ) const
+	{
+		uint8_t message [ 8 + 64 ];
+		std::memcpy ( message, &id, 8 );
+		if ( len <= 64 ) {
+			std::memcpy ( message + 8, value, len );
+			uint64_t term = ComputeSipHash ( sessionKey.data ( ), message, 8 + len );
+			SecureWipe ( message, sizeof ( message ) );
+			return term;
+		}
+
+		// Large values: hash the value first, then bind it to the id
+		uint64_t inner = ComputeSipHash ( sessionKey.data ( ), static_cast< const uint8_t* >( value ), len );
+		std::memcpy ( message + 8, &inner, 8 );
+		return ComputeSipHash ( sessionKey.data ( ), message, 16 );
+	}
+
+	void Add ( uint64_t term ) { digest.fetch_add ( term, std::memory_order_relaxed ); }
+	void Remove ( uint64_t term ) { digest.fetch_sub ( term, std::memory_order_relaxed ); }
+	void Replace ( uint64_t oldTerm, uint64_t newTerm ) { digest.fetch_add ( newTerm - oldTerm, std::memory_order_relaxed ); }
+
+	uint64_t Digest ( ) const { return digest.load ( std::memory_order_relaxed ); }
+	bool Matches ( uint64_t remoteDigest ) const { return Digest ( ) == remoteDigest; }
+};
+
+/**
+ * @brief Receiver for the write journal of SafeVars (see SafeJournal.hpp).
+ *
+ * Append() is called on every Set() of an attached variable with the fresh ciphertext and
+ * the keystream bytes it was masked with (value = cipher XOR mask). Implementations must copy the bytes and return
+ * quickly; sealing and I/O belong on a background stage.
+ */
+class SafeJournalSink
+{
+public:
+	virtual ~SafeJournalSink ( ) = default;
+	virtual void Append ( uint64_t id, uint64_t generation, const uint8_t* mask, const uint8_t* cipher, size_t len ) = 0;
+
+	// Largest value Append() accepts; checked once by SafeVar::AttachJournal
+	virtual size_t MaxValueSize ( ) const { return SIZE_MAX; }
+};
+
+// Receiver for the value history of a SafeVar<T> (see SafeHistory.hpp); Record() runs on every Set()
+template<typename T>
+class SafeHistorySink
+{
+public:
+	virtual ~SafeHistorySink ( ) = default;
+	virtual void Record ( const T& value ) = 0;
+};
+
+// Receiver of plaintext decoy copies (see SafeDecoy.hpp); slots are allocated by the sink
+class SafeDecoySink
+{
+public:
+	virtual ~SafeDecoySink ( ) = default;
+	virtual void Stage ( uint32_t slot, const void* value, size_t len ) = 0;
+	virtual void Release ( uint32_t slot ) = 0;
+	virtual uintptr_t Address ( uint32_t slot ) const = 0;
+
+	// The slot now mirrors owner (the SafeVar it travelled to with a move or Swap)
+	virtual void SetOwner ( uint32_t slot, const void* owner ) { }
+};
+
+// SafeVar class for secure variable handling with obfuscation and memory manipulation
+template<typename T>
+class SafeVar
+{
+	static_assert( std::is_trivially_copyable<T>::value&& std::is_default_constructible<T>::value,
+		"SafeVar<T> requires trivially copyable and default-constructible types." );
+
+private:
+	static MemoryPool memoryPool;
+	static constexpr size_t VALUE_SIZE = sizeof ( T );
+	using PadStore = SafePadStore<( 2 * sizeof ( T ) + 15 ) / 16 * 16>;   // buffer pad, then shadow pad
 
 	alignas( T ) std::array<uint8_t, VALUE_SIZE> buffer;
-	alignas( T ) std::array<uint8_t, VALUE_SIZE> key;
 	void* realMemory = nullptr;
 	uintptr_t fakeMemoryAddress = 0;
-	std::array<uint8_t, 12> nonce;
+	uint32_t keyEpoch = 0;            // keystream slices of buffer and shadowBuffer (see SafeKeystream)
+	uint64_t keyPosition = 0;
+	uint64_t shadowPosition = 0;
 	mutable uint32_t lastChecksum = 0;
 	bool isValid = false;
 	static constexpr uint32_t CANARY = 0xDEADC0DE;
 	uint32_t preCanary = CANARY;
 	uint32_t postCanary = CANARY;
 	alignas( T ) std::array<uint8_t, VALUE_SIZE> shadowBuffer;
-	alignas( T ) std::array<uint8_t, VALUE_SIZE> shadowKey;
+	SafeStateHash* stateHash = nullptr;
+	uint64_t stateId = 0;
+	uint64_t stateTerm = 0;
+	SafeJournalSink* journal = nullptr;
+	uint64_t journalId = 0;
+	uint64_t writeGeneration = 0;
+	uint64_t generationSeal = 0;
+	uint64_t hashTag = 0;
+	bool hasHashTag = false;
+	SafeHistorySink<T>* history = nullptr;
+	std::array<uint8_t, VALUE_SIZE> fallbackBuffer { };   // quarantine fallback XOR fallbackMask
+	std::array<uint8_t, VALUE_SIZE> fallbackMask { };
+	bool quarantineArmed = false;
+	mutable bool quarantined = false;
+	SafeQuarantineWrites quarantineWrites = SafeQuarantineWrites::Ignore;
+	SafeDecoySink* decoy = nullptr;
+	uint32_t decoySlot = 0;
+	uint32_t padIndex = PadStore::NO_SLOT;
+	SafeArena* arena = nullptr;           // real memory source; null = SafeArena::Instance()
+	SafeKeyDomain* keyDomain = nullptr;   // null = the writing thread's keystream
+	static std::atomic<bool> hashTagsEnabled;
+
+public:
+	using QuarantineWriteHandler = void ( * )( SafeVar& var, const T& attempted );
+
+private:
+	static std::atomic<QuarantineWriteHandler> quarantineWriteHandler;
+
+private:
+	// Encrypt value under a fresh slice of this thread's keystream
+	void Obfuscate ( const uint8_t* value, std::array<uint8_t, VALUE_SIZE>& outBuffer, uint64_t& positionOut )
+	{
+		if ( keyDomain ) {
+			keyDomain->Encrypt ( value, outBuffer.data ( ), VALUE_SIZE, keyEpoch, positionOut );
+			return;
+		}
+		SafeKeystream::Encrypt ( value, outBuffer.data ( ), VALUE_SIZE, keyEpoch, positionOut );
+	}
+
+	SafeArena& Arena ( ) const { return arena ? *arena : SafeArena::Instance ( ); }
+
+	// Re-encrypt under an already issued slice (decryption verification)
+	void Obfuscate ( const T& value, std::array<uint8_t, VALUE_SIZE>& outBuffer, uint64_t position ) const
+	{
+		SafeKeystream::Apply ( keyEpoch, position, reinterpret_cast< const uint8_t* >( &value ), outBuffer.data ( ), VALUE_SIZE );
+	}
+
+	T Deobfuscate ( const std::array<uint8_t, VALUE_SIZE>& inBuffer, uint64_t position ) const
+	{
+		T result;
+		SafeKeystream::Apply ( keyEpoch, position, inBuffer.data ( ), reinterpret_cast< uint8_t* >( &result ), VALUE_SIZE );
+		return result;
+	}
+
+	bool ValidateMemory ( ) const
+	{
+		if ( !realMemory || !isValid ) return false;
+		Arena ( ).EnsureOpen ( );
+
+		// Compare memory content with buffer
+		std::array<uint8_t, sizeof ( T )> memContent;
+		std::memcpy ( memContent.data ( ), realMemory, sizeof ( T ) );
+
+		return ( memContent == buffer );
+	}
+
+	// Binds the write generation to the current ciphertext, so neither can be rolled back alone
+	uint64_t ComputeGenerationSeal ( ) const
+	{
+		uint64_t sealed [ 2 ] = { writeGeneration, lastChecksum };
+		return ComputeSipHash ( SafeProcessHashKey ( ).data ( ), reinterpret_cast< const uint8_t* >( sealed ), sizeof ( sealed ) );
+	}
+
+	void SealGeneration ( ) { generationSeal = ComputeGenerationSeal ( ); }
+
+	// Shared verification pipeline of Get(), Peek() and Validate().
+	// callerAddress enables breakpoint detection, decryptedOut enables the decrypt/shadow/verify stage.
+	// checkIntegrity adds the checksum and generation seal; freeze detection otherwise belongs to
+	// Validate() and the generation sweeper, not to every read.
+	SafeVarStatus Inspect ( void* callerAddress, T* decryptedOut, bool checkIntegrity ) const
+	{
+		if ( !realMemory ) {
+			return SafeVarStatus::InvalidMemory;
+		}
+
+		if ( !ValidateMemory ( ) ) {
+			return SafeVarStatus::MemoryMismatch;
+		}
+
+		if ( checkIntegrity ) {
+			// Integrity check: detect memory freezing/tampering
+			uint32_t currentChecksum = ComputeChecksumFNV ( buffer.data ( ), buffer.size ( ) );
+			if ( currentChecksum != lastChecksum ) {
+				return SafeVarStatus::ChecksumMismatch;
+			}
+
+			if ( generationSeal != ComputeGenerationSeal ( ) ) {
+				return SafeVarStatus::GenerationMismatch;
+			}
+		}
+
+		// Breakpoint detection (basic)
+		if ( callerAddress && IsBreakpointPresent ( callerAddress ) ) {
+			return SafeVarStatus::BreakpointDetected;
+		}
 
-private:
-	// Add a state structure to ensure consistent encryption/decryption
-	struct CryptoState
-	{
-		alignas( T ) std::array<uint8_t, 32> fullKey;  // Always use 32-byte key
-		std::array<uint8_t, VALUE_SIZE> temp;
-	};
+		if ( !decryptedOut ) {
+			return SafeVarStatus::Ok;
+		}
 
-	void InitializeCryptoState ( CryptoState& cryptoState ) const
-	{
-		// Zero initialize the full key
-		cryptoState.fullKey.fill ( 0 );
+		// First decryption
+		T decrypted = Deobfuscate ( buffer, keyPosition );
+		T shadowDecrypted = Deobfuscate ( shadowBuffer, shadowPosition );
+		bool shadowMatches = std::memcmp ( &decrypted, &shadowDecrypted, VALUE_SIZE ) == 0;
+		SecureWipe ( &shadowDecrypted, VALUE_SIZE );
+		if ( !shadowMatches ) {
+			SecureWipe ( &decrypted, VALUE_SIZE );
+			return SafeVarStatus::ShadowMismatch;
+		}
 
-		// Copy our key into the full key buffer
-		std::copy ( key.begin ( ), key.end ( ), cryptoState.fullKey.begin ( ) );
+		// Verify decryption by re-encrypting and comparing
+		std::array<uint8_t, VALUE_SIZE> verify;
+		Obfuscate ( decrypted, verify, keyPosition );
+
+		if ( verify != buffer ) {
+			SecureWipe ( &decrypted, VALUE_SIZE );
+			return SafeVarStatus::VerificationFailed;
+		}
 
-		// Zero initialize temp buffer
-		cryptoState.temp.fill ( 0 );
+		*decryptedOut = decrypted;
+		SecureWipe ( &decrypted, VALUE_SIZE );
+		return SafeVarStatus::Ok;
 	}
 
-	void Obfuscate ( const T& value, std::array<uint8_t, VALUE_SIZE>& outBuffer ) const
+	// Precomputed-pad read: XOR against the pads, cross-checked with the shadow copy
+	SafeVarStatus ReadPad ( T& out ) const
 	{
-		CryptoState cryptoState;
-		InitializeCryptoState ( cryptoState );
+		const uint8_t* pad = PadStore::Instance ( ).Slot ( padIndex );
+		if ( !pad || !realMemory ) {
+			return SafeVarStatus::InvalidMemory;
+		}
 
-		// Copy value to temp buffer
-		std::memcpy ( cryptoState.temp.data ( ), &value, VALUE_SIZE );
+		if ( !ValidateMemory ( ) ) {
+			return SafeVarStatus::MemoryMismatch;
+		}
 
-		// Encrypt with full key
-		ChaCha20::Encrypt (
-			cryptoState.temp.data ( ),
-			outBuffer.data ( ),
-			VALUE_SIZE,
-			cryptoState.fullKey.data ( ),
-			nonce.data ( )
-		);
+		uint8_t* bytes = reinterpret_cast< uint8_t* >( &out );
+		uint8_t difference = 0;
+		for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+			bytes [ i ] = buffer [ i ] ^ pad [ i ];
+			difference |= bytes [ i ] ^ shadowBuffer [ i ] ^ pad [ VALUE_SIZE + i ];
+		}
+		if ( difference ) {
+			SecureWipe ( &out, VALUE_SIZE );
+			return SafeVarStatus::ShadowMismatch;
+		}
+		return SafeVarStatus::Ok;
 	}
 
-	void Obfuscate (
-		const T& value,
-		std::array<uint8_t, VALUE_SIZE>& outBuffer,
-		const std::array<uint8_t, VALUE_SIZE>& keyIn,
-		const std::array<uint8_t, 12>& nonceIn
-	) const
+	/**
+	 * Re-encryption without plaintext: turns mask (a target keystream) into target XOR in-memory
+	 * keystream, so buffer XOR mask is the value under the target keystream. The shadow copy is
+	 * checked the same way, by cancelling both keystreams out of buffer XOR shadow.
+	 */
+	SafeVarStatus FuseMask ( uint8_t* mask ) const
 	{
-		CryptoState cryptoState;
-		cryptoState.fullKey.fill ( 0 );
-		std::copy ( keyIn.begin ( ), keyIn.end ( ), cryptoState.fullKey.begin ( ) );
-		cryptoState.temp.fill ( 0 );
+		if ( preCanary != CANARY || postCanary != CANARY ) {
+			return SafeVarStatus::CanaryCorrupted;
+		}
+		if ( !realMemory ) {
+			return SafeVarStatus::InvalidMemory;
+		}
+		if ( !ValidateMemory ( ) ) {
+			return SafeVarStatus::MemoryMismatch;
+		}
+
+		std::array<uint8_t, VALUE_SIZE> difference;
+		for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+			difference [ i ] = buffer [ i ] ^ shadowBuffer [ i ];
+		}
+		SafeKeystream::Apply ( keyEpoch, keyPosition, difference.data ( ), difference.data ( ), VALUE_SIZE );
+		SafeKeystream::Apply ( keyEpoch, shadowPosition, difference.data ( ), difference.data ( ), VALUE_SIZE );
+		uint8_t mismatch = 0;
+		for ( uint8_t byte : difference ) mismatch |= byte;
+		if ( mismatch ) {
+			return SafeVarStatus::ShadowMismatch;
+		}
 
-		std::memcpy ( cryptoState.temp.data ( ), &value, VALUE_SIZE );
+		SafeKeystream::Apply ( keyEpoch, keyPosition, mask, mask, VALUE_SIZE );
+		return SafeVarStatus::Ok;
+	}
 
-		ChaCha20::Encrypt (
-			cryptoState.temp.data ( ),
-			outBuffer.data ( ),
-			VALUE_SIZE,
-			cryptoState.fullKey.data ( ),
-			nonceIn.data ( )
-		);
+	// Sealed-blob body of SerializeForTransport(); block1 may be null
+	SafeVarStatus SealTransport ( const uint8_t* transportKey, const uint8_t* nonce, const uint8_t* block0, const uint8_t* block1, uint8_t* out ) const
+	{
+		std::array<uint8_t, VALUE_SIZE> mask;
+		mask.fill ( 0 );
+		SafeSealedBlob::ApplyPayload ( transportKey, nonce, mask.data ( ), mask.data ( ), VALUE_SIZE, block1 );
+
+		SafeVarStatus status = FuseMask ( mask.data ( ) );
+		if ( status == SafeVarStatus::Ok ) {
+			SafeSealedBlob::WriteHeader ( out, VALUE_SIZE, nonce );
+			uint8_t* cipher = out + SafeSealedBlob::HEADER_SIZE;
+			for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+				cipher [ i ] = buffer [ i ] ^ mask [ i ];
+			}
+			uint64_t tag = SafeSealedBlob::ComputeTag ( block0, out, VALUE_SIZE );
+			std::memcpy ( cipher + VALUE_SIZE, &tag, SafeSealedBlob::TAG_SIZE );
+		}
+		else {
+			std::memset ( out, 0, TRANSPORT_SIZE );
+		}
+		SecureWipe ( mask.data ( ), VALUE_SIZE );
+		return status;
 	}
 
-	T Deobfuscate ( const std::array<uint8_t, VALUE_SIZE>& inBuffer ) const
+	T ReadFallback ( ) const
 	{
-		CryptoState cryptoState;
-		InitializeCryptoState ( cryptoState );
+		T value;
+		uint8_t* bytes = reinterpret_cast< uint8_t* >( &value );
+		for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+			bytes [ i ] = fallbackBuffer [ i ] ^ fallbackMask [ i ];
+		}
+		return value;
+	}
 
-		// Decrypt with full key
-		ChaCha20::Encrypt (
-			inBuffer.data ( ),
-			cryptoState.temp.data ( ),
-			VALUE_SIZE,
-			cryptoState.fullKey.data ( ),
-			nonce.data ( )
-		);
+	// Record a detection in the tamper log and enter quarantine if it is armed
+	void Flag ( SafeVarStatus status ) const
+	{
+		SafeTamperLog::Instance ( ).Report ( status, this );
+		if ( quarantineArmed ) quarantined = true;
+	}
 
-		T result;
-		std::memcpy ( &result, cryptoState.temp.data ( ), VALUE_SIZE );
-		return result;
+	// Detection on a read: armed variables fall back, others keep throwing
+	T Contain ( SafeVarStatus status ) const
+	{
+		Flag ( status );
+		if ( !quarantineArmed ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+		return ReadFallback ( );
 	}
 
-	T Deobfuscate ( const std::array<uint8_t, VALUE_SIZE>& inBuffer,
-		const std::array<uint8_t, VALUE_SIZE>& keyIn,
-		const std::array<uint8_t, 12>& nonceIn ) const
+public:
+	SafeVar ( ) { Set ( T {} ); }
+	SafeVar ( const T& value ) { Set ( value ); }
+
+	// Variable living in a SafeDomain: real memory from domainArena, keystream from domainKeys
+	SafeVar ( SafeArena& domainArena, SafeKeyDomain& domainKeys, const T& value )
+		: arena ( &domainArena ), keyDomain ( &domainKeys )
 	{
-		CryptoState cryptoState;
-		// Zero initialize the full key
-		cryptoState.fullKey.fill ( 0 );
-		std::copy ( keyIn.begin ( ), keyIn.end ( ), cryptoState.fullKey.begin ( ) );
-		cryptoState.temp.fill ( 0 );
+		Set ( value );
+	}
 
-		// Decrypt with provided key/nonce
-		ChaCha20::Encrypt (
-			inBuffer.data ( ),
-			cryptoState.temp.data ( ),
-			VALUE_SIZE,
-			cryptoState.fullKey.data ( ),
-			nonceIn.data ( )
-		);
+	~SafeVar ( ) { DetachStateHash ( ); DetachDecoy ( ); DisablePad ( ); Clear ( ); }
 
-		T result;
-		std::memcpy ( &result, cryptoState.temp.data ( ), VALUE_SIZE );
-		return result;
+	// Copies clone the ciphertext into fresh real memory instead of sharing it.
+	// Attachments (state hash, journal) belong to the original and are not copied.
+	SafeVar ( const SafeVar& other ) { CloneFrom ( other ); }
+
+	// Moves hand over the ciphertext, real memory and attachments; other is left empty.
+	// Not noexcept: moving a SafeDomain variable re-encrypts it into fresh storage, which can throw.
+	SafeVar ( SafeVar&& other )
+	{
+		Clear ( );
+		shadowBuffer.fill ( 0 );
+		Swap ( other );
 	}
 
-	bool ValidateMemory ( ) const
+	// Copy assignment counts as a write of this variable and notifies its attachments
+	SafeVar& operator=( const SafeVar& other )
 	{
-		if ( !realMemory || !isValid ) return false;
+		if ( this != &other ) {
+			CloneFrom ( other );
+			if ( realMemory ) {
+				T current = Deobfuscate ( buffer, keyPosition );
+				OnWrite ( current );
+				SecureWipe ( &current, VALUE_SIZE );
+			}
+		}
+		return *this;
+	}
 
-		// Compare memory content with buffer
-		std::array<uint8_t, sizeof ( T )> memContent;
-		std::memcpy ( memContent.data ( ), realMemory, sizeof ( T ) );
+	SafeVar& operator=( SafeVar&& other )
+	{
+		if ( this != &other ) {
+			SafeVar discarded ( std::move ( other ) );
+			Swap ( discarded );
+		}
+		return *this;
+	}
 
-		return ( memContent == buffer );
+	// Exchange values without decrypting. Attachments travel with the values, so a state
+	// hash or journal keeps describing the same logical variable after the swap. Between
+	// different arenas or key domains (SafeDomain) the values are re-encrypted instead; only
+	// that path allocates and can throw, leaving both variables as they were.
+	void Swap ( SafeVar& other )
+	{
+		if ( arena != other.arena || keyDomain != other.keyDomain ) {
+			SwapAcrossDomains ( other );
+			return;
+		}
+
+		std::swap ( buffer, other.buffer );
+		std::swap ( realMemory, other.realMemory );
+		std::swap ( fakeMemoryAddress, other.fakeMemoryAddress );
+		std::swap ( keyEpoch, other.keyEpoch );
+		std::swap ( keyPosition, other.keyPosition );
+		std::swap ( shadowPosition, other.shadowPosition );
+		std::swap ( lastChecksum, other.lastChecksum );
+		std::swap ( isValid, other.isValid );
+		std::swap ( shadowBuffer, other.shadowBuffer );
+		std::swap ( stateHash, other.stateHash );
+		std::swap ( stateId, other.stateId );
+		std::swap ( stateTerm, other.stateTerm );
+		std::swap ( journal, other.journal );
+		std::swap ( journalId, other.journalId );
+		std::swap ( writeGeneration, other.writeGeneration );
+		std::swap ( generationSeal, other.generationSeal );
+		std::swap ( hashTag, other.hashTag );
+		std::swap ( hasHashTag, other.hasHashTag );
+		std::swap ( history, other.history );
+		std::swap ( fallbackBuffer, other.fallbackBuffer );
+		std::swap ( fallbackMask, other.fallbackMask );
+		std::swap ( quarantineArmed, other.quarantineArmed );
+		std::swap ( quarantined, other.quarantined );
+		std::swap ( quarantineWrites, other.quarantineWrites );
+		std::swap ( decoy, other.decoy );
+		std::swap ( decoySlot, other.decoySlot );
+		if ( decoy ) decoy->SetOwner ( decoySlot, this );
+		if ( other.decoy ) other.decoy->SetOwner ( other.decoySlot, &other );
+		std::swap ( padIndex, other.padIndex );
+		std::swap ( arena, other.arena );
+		std::swap ( keyDomain, other.keyDomain );
 	}
 
-	void GenerateKey ( std::array<uint8_t, VALUE_SIZE>& keyOut )
+	friend void swap ( SafeVar& a, SafeVar& b ) { a.Swap ( b ); }
+
+private:
+	// Storage cannot change hands between arenas or key domains: each side keeps its own real
+	// memory, keys and pad and re-encrypts the other's value. A side without a value (moved
+	// from) leaves the other side empty. Attachments and write state swap as usual.
+	// The values are stored first, so a failed allocation leaves both sides untouched.
+	void SwapAcrossDomains ( SafeVar& other )
 	{
-		std::random_device rd;
-		std::mt19937 gen ( rd ( ) );
-		std::uniform_int_distribution<> dis ( 0, 255 );
+		bool mineSet = realMemory != nullptr;
+		bool theirsSet = other.realMemory != nullptr;
+		std::array<uint8_t, VALUE_SIZE> mine, theirs;
+		if ( mineSet ) SafeKeystream::Apply ( keyEpoch, keyPosition, buffer.data ( ), mine.data ( ), VALUE_SIZE );
+		if ( theirsSet ) SafeKeystream::Apply ( other.keyEpoch, other.keyPosition, other.buffer.data ( ), theirs.data ( ), VALUE_SIZE );
 
-		keyOut.fill ( 0 );  // Zero initialize first
-		for ( size_t i = 0; i < VALUE_SIZE && i < 32; ++i ) {
-			keyOut [ i ] = static_cast< uint8_t > ( dis ( gen ) );
+		try {
+			if ( theirsSet ) StoreBytes ( theirs.data ( ) );
+			try {
+				if ( mineSet ) other.StoreBytes ( mine.data ( ) );
+			}
+			catch ( ... ) {
+				// Put our own value back before reporting the failure
+				if ( mineSet ) StoreBytes ( mine.data ( ) );
+				else ClearValue ( );
+				throw;
+			}
+		}
+		catch ( ... ) {
+			SecureWipe ( mine.data ( ), VALUE_SIZE );
+			SecureWipe ( theirs.data ( ), VALUE_SIZE );
+			throw;
 		}
+		if ( !theirsSet ) ClearValue ( );
+		if ( !mineSet ) other.ClearValue ( );
+		SecureWipe ( mine.data ( ), VALUE_SIZE );
+		SecureWipe ( theirs.data ( ), VALUE_SIZE );
+
+		std::swap ( stateHash, other.stateHash );
+		std::swap ( stateId, other.stateId );
+		std::swap ( stateTerm, other.stateTerm );
+		std::swap ( journal, other.journal );
+		std::swap ( journalId, other.journalId );
+		std::swap ( writeGeneration, other.writeGeneration );
+		std::swap ( hashTag, other.hashTag );
+		std::swap ( hasHashTag, other.hasHashTag );
+		std::swap ( history, other.history );
+		std::swap ( fallbackBuffer, other.fallbackBuffer );
+		std::swap ( fallbackMask, other.fallbackMask );
+		std::swap ( quarantineArmed, other.quarantineArmed );
+		std::swap ( quarantined, other.quarantined );
+		std::swap ( quarantineWrites, other.quarantineWrites );
+		std::swap ( decoy, other.decoy );
+		std::swap ( decoySlot, other.decoySlot );
+		if ( decoy ) decoy->SetOwner ( decoySlot, this );
+		if ( other.decoy ) other.decoy->SetOwner ( other.decoySlot, &other );
+
+		// The seals cover the write generation, which only now belongs to the new value
+		if ( realMemory ) SealGeneration ( );
+		if ( other.realMemory ) other.SealGeneration ( );
+	}
+
+	// Back to the moved-from state: no real memory and nothing to decrypt
+	void ClearValue ( )
+	{
+		Clear ( );
+		shadowBuffer.fill ( 0 );
+		lastChecksum = 0;
+		isValid = false;
 	}
 
 public:
-	SafeVar ( ) { Set ( T {} ); }
-	SafeVar ( const T& value ) { Set ( value ); }
-	~SafeVar ( ) { Clear ( ); }
 
 	T Get ( bool encrypted = false ) const
 	{
-		if ( preCanary != CANARY || postCanary != CANARY )
-			throw std::runtime_error ( "Buffer overflow/underrun detected" );
+		// Quarantined variables answer from the fallback without touching the tampered state
+		if ( quarantined && !encrypted ) return ReadFallback ( );
+
+		if ( preCanary != CANARY || postCanary != CANARY ) {
+			T fallback = Contain ( SafeVarStatus::CanaryCorrupted );
+			if ( !encrypted ) return fallback;
+		}
+
+		// Read-heavy values with a precomputed pad: no decryption and no re-key per read
+		if ( padIndex != PadStore::NO_SLOT && !encrypted ) {
+			T value;
+			SafeVarStatus status = ReadPad ( value );
+			return status == SafeVarStatus::Ok ? value : Contain ( status );
+		}
 
 		static thread_local bool inGet = false;
 		if ( inGet ) {
@@ -417,46 +2018,23 @@ public:
 		inGet = true;
 
 		try {
-			if ( !realMemory ) {
-				throw std::runtime_error ( "Invalid memory state" );
-			}
-
-			if ( !ValidateMemory ( ) ) {
-				throw std::runtime_error ( "Memory validation failed" );
-			}
-
-			// Integrity check: detect memory freezing/tampering
-			uint32_t currentChecksum = ComputeChecksumFNV ( buffer.data ( ), buffer.size ( ) );
-			if ( currentChecksum != lastChecksum ) {
-				throw std::runtime_error ( "Integrity check failed: possible memory freezing or tampering detected" );
-			}
-
-			// Breakpoint detection (basic)
-			void* addr = _ReturnAddress ( );
-			if ( IsBreakpointPresent ( addr ) ) {
-				throw std::runtime_error ( "Breakpoint detected in SafeVar::Get()" );
+			T decrypted;
+			SafeVarStatus status = Inspect ( _ReturnAddress ( ), encrypted ? nullptr : &decrypted, false );
+			if ( status != SafeVarStatus::Ok ) {
+				T fallback = Contain ( status );
+				if ( !encrypted ) {
+					inGet = false;
+					return fallback;
+				}
 			}
 
 			if ( encrypted ) {
 				T raw;
 				std::memcpy ( &raw, buffer.data ( ), VALUE_SIZE );
+				inGet = false;
 				return raw;
 			}
 
-			// First decryption
-			T decrypted = Deobfuscate ( buffer );
-			T shadowDecrypted = Deobfuscate ( shadowBuffer, shadowKey, nonce );
-			if ( decrypted != shadowDecrypted )
-				throw std::runtime_error ( "Memory tampering detected: shadow copy mismatch" );
-
-			// Verify decryption by re-encrypting and comparing
-			std::array<uint8_t, VALUE_SIZE> verify;
-			Obfuscate ( decrypted, verify );
-
-			if ( verify != buffer ) {
-				throw std::runtime_error ( "Decryption verification failed" );
-			}
-
 			// Optional: re-key after each access to break static freezing
 			const_cast< SafeVar* >( this )->ReKey ( );
 
@@ -469,6 +2047,34 @@ public:
 		}
 	}
 
+	// Non-throwing integrity check. Runs the Get() verification plus the checksum and generation
+	// seal, but does not re-key and does not hand out the plaintext; meant for bulk sweeps.
+	SafeVarStatus Validate ( ) const
+	{
+		SafeVarStatus status = SafeVarStatus::CanaryCorrupted;
+		if ( preCanary == CANARY && postCanary == CANARY ) {
+			T scratch;
+			status = Inspect ( nullptr, &scratch, true );
+			SecureWipe ( &scratch, VALUE_SIZE );
+		}
+
+		if ( status != SafeVarStatus::Ok ) Flag ( status );
+		return status;
+	}
+
+	// Verified read without re-keying, for algorithms that decrypt many values once each
+	// (sorting, searching). out is only written when the result is Ok.
+	SafeVarStatus Peek ( T& out ) const
+	{
+		if ( preCanary != CANARY || postCanary != CANARY )
+			return SafeVarStatus::CanaryCorrupted;
+
+		if ( padIndex != PadStore::NO_SLOT ) {
+			return ReadPad ( out );
+		}
+		return Inspect ( nullptr, &out, false );
+	}
+
 	const std::array<uint8_t, VALUE_SIZE>& GetInternalValue ( ) const
 	{
 		return buffer;
@@ -486,27 +2092,361 @@ public:
 	}
 
 	T Set ( const T& value )
+	{
+		if ( quarantined ) {
+			QuarantineWriteHandler handler = quarantineWriteHandler.load ( std::memory_order_relaxed );
+			if ( quarantineWrites == SafeQuarantineWrites::Route && handler ) handler ( *this, value );
+			return value;
+		}
+
+		Store ( value );
+		OnWrite ( value );
+		return value;
+	}
+
+	/**
+	 * Set from VALUE_SIZE raw bytes in T's object representation, e.g. straight out of a
+	 * receive buffer. The bytes need no alignment and are encrypted in place without an
+	 * intermediate T; only the history attachment and routed quarantine writes get a copy.
+	 */
+	void SetFromBytes ( const uint8_t* value )
+	{
+		if ( quarantined ) {
+			T copy;
+			std::memcpy ( &copy, value, VALUE_SIZE );
+			Set ( copy );
+			SecureWipe ( &copy, VALUE_SIZE );
+			return;
+		}
+
+		StoreBytes ( value );
+		OnWriteBytes ( value );
+	}
+
+	void ReKey ( )
+	{
+		T current = Deobfuscate ( buffer, keyPosition );
+		Store ( current );
+		SecureWipe ( &current, VALUE_SIZE );
+	}
+
+	// Include this variable in an incremental state hash under a caller-chosen stable id
+	void AttachStateHash ( SafeStateHash* hash, uint64_t id )
+	{
+		DetachStateHash ( );
+		if ( !hash ) return;
+
+		T current;
+		SafeVarStatus status = Inspect ( nullptr, &current, false );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+
+		stateHash = hash;
+		stateId = id;
+		stateTerm = hash->Contribution ( id, &current, VALUE_SIZE );
+		hash->Add ( stateTerm );
+		SecureWipe ( &current, VALUE_SIZE );
+	}
+
+	void DetachStateHash ( )
+	{
+		if ( stateHash ) {
+			stateHash->Remove ( stateTerm );
+			stateHash = nullptr;
+			stateTerm = 0;
+		}
+	}
+
+	const SafeStateHash* AttachedStateHash ( ) const { return stateHash; }
+
+	// Opt-in audit trail: every Set() appends (id, generation, ciphertext) to the journal
+	void AttachJournal ( SafeJournalSink* sink, uint64_t id )
+	{
+		if ( sink && VALUE_SIZE > sink->MaxValueSize ( ) ) {
+			throw std::length_error ( "SafeVar: value too large for this journal" );
+		}
+		journal = sink;
+		journalId = id;
+	}
+
+	void DetachJournal ( ) { journal = nullptr; }
+
+	// Decoy mirror: the sink owns the slot, stages every Set() and backs GetFakeAddress().
+	// Use SafeDecoyPages::Attach() rather than calling this directly.
+	void AttachDecoy ( SafeDecoySink* sink, uint32_t slot )
+	{
+		DetachDecoy ( );
+		decoy = sink;
+		decoySlot = slot;
+	}
+
+	void DetachDecoy ( )
+	{
+		if ( decoy ) {
+			decoy->Release ( decoySlot );
+			decoy = nullptr;
+			decoySlot = 0;
+		}
+	}
+
+	bool HasDecoy ( ) const { return decoy != nullptr; }
+
+	/**
+	 * Precomputed pad for read-heavy values: Set() and ReKey() copy the keystream of the buffer
+	 * and shadow into a slot of the separate pad store, and Get()/Peek() become an XOR plus the
+	 * real-memory and shadow checks. Reads no longer re-key; call ReKey() on your own schedule.
+	 * Not available for SafeDomain variables.
+	 */
+	void EnablePad ( )
+	{
+		if ( padIndex != PadStore::NO_SLOT ) return;
+		if ( keyDomain ) {
+			// SafeDomain::Close() frees domain memory without visiting variables, so a pad would leak
+			throw std::runtime_error ( "SafeVar: pads are not available for SafeDomain variables" );
+		}
+
+		T current;
+		SafeVarStatus status = Inspect ( nullptr, &current, false );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+		padIndex = PadStore::Instance ( ).Acquire ( );
+		Store ( current );
+		SecureWipe ( &current, VALUE_SIZE );
+	}
+
+	void DisablePad ( )
+	{
+		if ( padIndex != PadStore::NO_SLOT ) {
+			PadStore::Instance ( ).Release ( padIndex );
+			padIndex = PadStore::NO_SLOT;
+		}
+	}
+
+	bool HasPad ( ) const { return padIndex != PadStore::NO_SLOT; }
+
+	// Opt-in value history: every Set() hands the new value to the sink (anomaly checks)
+	void AttachHistory ( SafeHistorySink<T>* sink ) { history = sink; }
+	void DetachHistory ( ) { history = nullptr; }
+
+	/**
+	 * Tamper containment. Once armed, the first detection (Get, Validate or Quarantine()) puts
+	 * the variable into quarantine: reads return the fallback without re-running the checks,
+	 * and writes are dropped or routed to the type's handler until LiftQuarantine().
+	 * Detections are reported to SafeTamperLog instead of being thrown.
+	 */
+	void EnableQuarantine ( const T& fallback, SafeQuarantineWrites writes = SafeQuarantineWrites::Ignore )
+	{
+		GenerateRandomBytes ( fallbackMask.data ( ), VALUE_SIZE );
+		const uint8_t* bytes = reinterpret_cast< const uint8_t* >( &fallback );
+		for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+			fallbackBuffer [ i ] = bytes [ i ] ^ fallbackMask [ i ];
+		}
+		quarantineWrites = writes;
+		quarantineArmed = true;
+	}
+
+	void DisableQuarantine ( )
+	{
+		quarantineArmed = false;
+		quarantined = false;
+		SecureWipe ( fallbackBuffer.data ( ), VALUE_SIZE );
+		SecureWipe ( fallbackMask.data ( ), VALUE_SIZE );
+	}
+
+	// Quarantine on external evidence (e.g. a sweeper detection); needs EnableQuarantine() first
+	void Quarantine ( ) { quarantined = quarantineArmed; }
+
+	// Leave quarantine with an authoritative value (fresh keystream slices and real memory)
+	void LiftQuarantine ( const T& value )
+	{
+		quarantined = false;
+		Set ( value );
+	}
+
+	bool IsQuarantined ( ) const { return quarantined; }
+
+	static void SetQuarantineWriteHandler ( QuarantineWriteHandler handler )
+	{
+		quarantineWriteHandler.store ( handler, std::memory_order_relaxed );
+	}
+
+	// Number of legitimate writes (Set calls) since construction; re-keying does not count
+	uint64_t GetWriteGeneration ( ) const { return writeGeneration; }
+
+	// O(1) freeze check for sweepers: verifies the generation seal and reports the generation.
+	// A frozen or restored variable either breaks the seal or stops advancing / goes backwards.
+	SafeVarStatus CheckGeneration ( uint64_t& generationOut ) const
+	{
+		if ( preCanary != CANARY || postCanary != CANARY )
+			return SafeVarStatus::CanaryCorrupted;
+		if ( generationSeal != ComputeGenerationSeal ( ) )
+			return SafeVarStatus::GenerationMismatch;
+
+		generationOut = writeGeneration;
+		return SafeVarStatus::Ok;
+	}
+
+	/**
+	 * Keyed hash tags: when enabled for a type, every Set() stores SipHash(process secret, value).
+	 * std::hash<SafeVar<T>> and operator==/!= use the tag so hashing and inequality need no
+	 * decryption. Equal values share a tag, so enable this only for types used as keys.
+	 *
+	 * Tags hash the object representation, so they are limited to integral, enum and pointer
+	 * types, where equal values have equal bytes. Floats (+0/-0, NaN) and structs with padding
+	 * are rejected at compile time; operator== on them always compares decrypted values.
+	 */
+	static constexpr bool HASHABLE_REPRESENTATION =
+		std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value;
+
+	static void EnableHashTags ( bool enable )
+	{
+		static_assert( HASHABLE_REPRESENTATION, "SafeVar hash tags need an integral, enum or pointer type." );
+		hashTagsEnabled.store ( enable, std::memory_order_relaxed );
+	}
+	static bool HashTagsEnabled ( ) { return HASHABLE_REPRESENTATION && hashTagsEnabled.load ( std::memory_order_relaxed ); }
+
+	static uint64_t ComputeHashTag ( const T& value )
+	{
+		static_assert( HASHABLE_REPRESENTATION, "SafeVar hash tags need an integral, enum or pointer type." );
+		return ComputeSipHash ( SafeProcessHashKey ( ).data ( ), reinterpret_cast< const uint8_t* >( &value ), VALUE_SIZE );
+	}
+
+	// Keyed hash of the value; served from the stored tag when present, otherwise via Peek()
+	uint64_t HashTag ( ) const
+	{
+		if ( hasHashTag ) return hashTag;
+
+		T current;
+		SafeVarStatus status = Peek ( current );
+		if ( status != SafeVarStatus::Ok ) {
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+		uint64_t tag = ComputeHashTag ( current );
+		SecureWipe ( &current, VALUE_SIZE );
+		return tag;
+	}
+
+	bool HasHashTag ( ) const { return hasHashTag; }
+
+	// Tag a value written before tags were enabled
+	void RefreshHashTag ( )
+	{
+		hashTag = HashTag ( );
+		hasHashTag = true;
+	}
+
+private:
+	// Legitimate writes (Set and everything built on it) pass through here; re-keying does not
+	void OnWrite ( const T& value ) { OnWriteBytes ( reinterpret_cast< const uint8_t* >( &value ) ); }
+
+	void OnWriteBytes ( const uint8_t* plain )
+	{
+		++writeGeneration;
+		SealGeneration ( );
+
+		hasHashTag = HashTagsEnabled ( );
+		hashTag = hasHashTag ? ComputeSipHash ( SafeProcessHashKey ( ).data ( ), plain, VALUE_SIZE ) : 0;
+
+		if ( history ) {
+			T value;
+			std::memcpy ( &value, plain, VALUE_SIZE );
+			history->Record ( value );
+			SecureWipe ( &value, VALUE_SIZE );
+		}
+
+		if ( decoy ) {
+			decoy->Stage ( decoySlot, plain, VALUE_SIZE );
+		}
+
+		if ( journal ) {
+			// The keystream slice is recovered as ciphertext XOR plaintext
+			std::array<uint8_t, VALUE_SIZE> mask;
+			for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+				mask [ i ] = buffer [ i ] ^ plain [ i ];
+			}
+			journal->Append ( journalId, writeGeneration, mask.data ( ), buffer.data ( ), VALUE_SIZE );
+			SecureWipe ( mask.data ( ), VALUE_SIZE );
+		}
+
+		if ( stateHash ) {
+			uint64_t term = stateHash->Contribution ( stateId, plain, VALUE_SIZE );
+			stateHash->Replace ( stateTerm, term );
+			stateTerm = term;
+		}
+	}
+
+	void CloneFrom ( const SafeVar& other )
 	{
 		Clear ( );
-		GenerateKey ( key );
-		GenerateNonce ( nonce );
-		Obfuscate ( value, buffer );
-		Obfuscate ( value, shadowBuffer, shadowKey, nonce );
-		realMemory = RealMemoryAllocator::AllocateRealMemory ( VALUE_SIZE );
-		if ( !realMemory ) throw std::runtime_error ( "Memory allocation failed" );
+		if ( !other.realMemory ) return;
+
+		buffer = other.buffer;
+		keyEpoch = other.keyEpoch;
+		keyPosition = other.keyPosition;
+		shadowPosition = other.shadowPosition;
+		shadowBuffer = other.shadowBuffer;
+		lastChecksum = other.lastChecksum;
+		hashTag = other.hashTag;
+		hasHashTag = other.hasHashTag;
+		fallbackBuffer = other.fallbackBuffer;
+		fallbackMask = other.fallbackMask;
+		quarantineArmed = other.quarantineArmed;
+		quarantined = other.quarantined;
+		quarantineWrites = other.quarantineWrites;
+		const uint8_t* otherPad = PadStore::Instance ( ).Slot ( other.padIndex );
+		if ( otherPad && !keyDomain ) {
+			if ( padIndex == PadStore::NO_SLOT ) padIndex = PadStore::Instance ( ).Acquire ( );
+			std::memcpy ( PadStore::Instance ( ).Slot ( padIndex ), otherPad, 2 * VALUE_SIZE );
+		}
+		else {
+			DisablePad ( );
+		}
+		SafeArena& target = Arena ( );
+		target.EnsureOpen ( );
+		realMemory = target.Allocate ( VALUE_SIZE );
 		std::memcpy ( realMemory, buffer.data ( ), VALUE_SIZE );
-		lastChecksum = ComputeChecksumFNV ( buffer.data ( ), buffer.size ( ) );
 		fakeMemoryAddress = FakeMemoryAllocator::AllocateFakeMemory ( VALUE_SIZE );
 		isValid = true;
-		return value;
+		SealGeneration ( );
+
+		// Across domains the ciphertext is re-encrypted, so the copy does not die with the source's keys
+		if ( keyDomain != other.keyDomain ) {
+			T value = Deobfuscate ( buffer, keyPosition );
+			Store ( value );
+			SecureWipe ( &value, VALUE_SIZE );
+		}
 	}
 
-	void ReKey ( )
+	void Store ( const T& value ) { StoreBytes ( reinterpret_cast< const uint8_t* >( &value ) ); }
+
+	// Encrypt value under fresh keystream slices and move it to new real memory
+	void StoreBytes ( const uint8_t* plain )
 	{
-		T current = Deobfuscate ( buffer );
-		Set ( current );
+		// Take the new slot before releasing the old one, so the value always changes address
+		SafeArena& target = Arena ( );
+		target.EnsureOpen ( );
+		void* fresh = target.Allocate ( VALUE_SIZE );
+		Clear ( );
+		Obfuscate ( plain, buffer, keyPosition );
+		Obfuscate ( plain, shadowBuffer, shadowPosition );
+		if ( uint8_t* pad = PadStore::Instance ( ).Slot ( padIndex ) ) {
+			for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+				pad [ i ] = buffer [ i ] ^ plain [ i ];
+				pad [ VALUE_SIZE + i ] = shadowBuffer [ i ] ^ plain [ i ];
+			}
+		}
+		realMemory = fresh;
+		std::memcpy ( realMemory, buffer.data ( ), VALUE_SIZE );
+		lastChecksum = ComputeChecksumFNV ( buffer.data ( ), buffer.size ( ) );
+		fakeMemoryAddress = FakeMemoryAllocator::AllocateFakeMemory ( VALUE_SIZE );
+		isValid = true;
+		SealGeneration ( );
 	}
 
+public:
+
 	operator T( ) const { return Get ( ); }
 
 	void* operator new( size_t size )
@@ -571,8 +2511,13 @@ public:
 	}
 
 	// Comparison operators
-	bool operator==( const SafeVar<T>& other ) const { return Get ( ) == other.Get ( ); }
-	bool operator!=( const SafeVar<T>& other ) const { return Get ( ) != other.Get ( ); }
+	bool operator==( const SafeVar<T>& other ) const
+	{
+		// Different tags prove different values; only a tag match needs decryption
+		if ( hasHashTag && other.hasHashTag && hashTag != other.hashTag ) return false;
+		return Get ( ) == other.Get ( );
+	}
+	bool operator!=( const SafeVar<T>& other ) const { return !( *this == other ); }
 	bool operator<( const SafeVar<T>& other ) const { return Get ( ) < other.Get ( ); }
 	bool operator<=( const SafeVar<T>& other ) const { return Get ( ) <= other.Get ( ); }
 	bool operator>( const SafeVar<T>& other ) const { return Get ( ) > other.Get ( ); }
@@ -615,10 +2560,10 @@ public:
 		return reinterpret_cast< uintptr_t >( realMemory );
 	}
 
-	// Fake address manipulation: Return fake memory address (simulated for cheaters)
+	// Fake address manipulation: the decoy slot when one is attached, otherwise a simulated address
 	uintptr_t GetFakeAddress ( ) const
 	{
-		return fakeMemoryAddress;
+		return decoy ? decoy->Address ( decoySlot ) : fakeMemoryAddress;
 	}
 
 	friend std::ostream& operator<<( std::ostream& os, const SafeVar& var )
@@ -626,43 +2571,113 @@ public:
 		return os << var.Get ( ); // This should use the Get() function to access the value.
 	}
 
+	// Size of a SerializeForTransport() blob
+	static constexpr size_t TRANSPORT_SIZE = SafeSealedBlob::SealedSize ( sizeof ( T ) );
+
+	// Layout: [nonce 12][export key VALUE_SIZE][ciphertext VALUE_SIZE], under a fresh export key per call.
+	// The key travels with the data, so this only obfuscates; use SerializeForTransport() for the wire.
 	std::array<uint8_t, VALUE_SIZE + 12 + VALUE_SIZE> Serialize ( ) const
 	{
 		std::array<uint8_t, VALUE_SIZE + 12 + VALUE_SIZE> out;
 
-		// Store nonce (12 bytes for ChaCha20)
-		std::memcpy ( out.data ( ), nonce.data ( ), 12 );
+		GenerateRandomBytes ( out.data ( ), 12 + VALUE_SIZE );
+		uint8_t fullKey [ 32 ] = { };
+		std::memcpy ( fullKey, out.data ( ) + 12, VALUE_SIZE < 32 ? VALUE_SIZE : 32 );
+
+		// Export keystream fused with the in-memory one; the plaintext is never formed
+		std::array<uint8_t, VALUE_SIZE> mask;
+		mask.fill ( 0 );
+		ChaCha20::Encrypt ( mask.data ( ), mask.data ( ), VALUE_SIZE, fullKey, out.data ( ) );
+		SecureWipe ( fullKey, sizeof ( fullKey ) );
+
+		SafeVarStatus status = FuseMask ( mask.data ( ) );
+		if ( status != SafeVarStatus::Ok ) {
+			SecureWipe ( mask.data ( ), VALUE_SIZE );
+			throw std::runtime_error ( SafeVarStatusMessage ( status ) );
+		}
+		for ( size_t i = 0; i < VALUE_SIZE; ++i ) {
+			out [ 12 + VALUE_SIZE + i ] = buffer [ i ] ^ mask [ i ];
+		}
+		SecureWipe ( mask.data ( ), VALUE_SIZE );
+		return out;
+	}
 
-		// Store key (to ensure consistency during deserialization)
-		std::memcpy ( out.data ( ) + 12, key.data ( ), VALUE_SIZE );
+	/**
+	 * Seal the value for the wire as a SafeSealedBlob (TRANSPORT_SIZE bytes into out) under a
+	 * 32-byte transport key and an 8-byte nonce that must not repeat under that key. The
+	 * in-memory and transport keystreams are combined first and applied to the ciphertext in
+	 * one pass, so the plaintext is never written to memory and nothing is re-keyed.
+	 * On failure out is zeroed and the integrity status is returned.
+	 */
+	SafeVarStatus SerializeForTransport ( const uint8_t* transportKey, const uint8_t* nonce, uint8_t* out ) const
+	{
+		uint8_t block0 [ 64 ];
+		ChaCha20::KeystreamBlocks ( transportKey, nonce, 0, block0, 1 );
+		SafeVarStatus status = SealTransport ( transportKey, nonce, block0, nullptr, out );
+		SecureWipe ( block0, sizeof ( block0 ) );
+		return status;
+	}
 
-		// Encrypt buffer
-		std::array<uint8_t, VALUE_SIZE> encrypted;
-		ChaCha20::Encrypt ( buffer.data ( ), encrypted.data ( ), VALUE_SIZE, key.data ( ), nonce.data ( ) );
+	/**
+	 * Bulk SerializeForTransport(): vars[i] is sealed with nonce firstNonce + i (little-endian)
+	 * into out + i * TRANSPORT_SIZE, and statuses[i] receives its status. Four variables share
+	 * each pass of the multi-lane keystream kernel. Returns the number sealed successfully.
+	 */
+	static size_t SerializeForTransport ( const SafeVar* const* vars, size_t count, const uint8_t* transportKey, uint64_t firstNonce, uint8_t* out, SafeVarStatus* statuses )
+	{
+		const size_t lanes = 4;
+		uint8_t nonces [ lanes ][ SafeSealedBlob::NONCE_SIZE ];
+		uint8_t block0 [ lanes * 64 ], block1 [ lanes * 64 ];
+		size_t sealed = 0;
+
+		for ( size_t first = 0; first < count; first += lanes ) {
+			const uint8_t* noncePtrs [ lanes ];
+			for ( size_t lane = 0; lane < lanes; ++lane ) {
+				uint64_t nonce = firstNonce + first + lane;
+				std::memcpy ( nonces [ lane ], &nonce, SafeSealedBlob::NONCE_SIZE );
+				noncePtrs [ lane ] = nonces [ lane ];
+			}
+			ChaCha20::KeystreamLanes ( transportKey, noncePtrs, 0, block0 );
+			ChaCha20::KeystreamLanes ( transportKey, noncePtrs, 1, block1 );
 
-		// Append encrypted data
-		std::memcpy ( out.data ( ) + 12 + VALUE_SIZE, encrypted.data ( ), VALUE_SIZE );
+			for ( size_t lane = 0; lane < lanes && first + lane < count; ++lane ) {
+				size_t i = first + lane;
+				statuses [ i ] = vars [ i ]->SealTransport ( transportKey, nonces [ lane ], block0 + lane * 64, block1 + lane * 64, out + i * TRANSPORT_SIZE );
+				sealed += statuses [ i ] == SafeVarStatus::Ok ? 1 : 0;
+			}
+		}
 
-		return out;
+		SecureWipe ( block0, sizeof ( block0 ) );
+		SecureWipe ( block1, sizeof ( block1 ) );
+		return sealed;
 	}
 
+	// Counts as a write on Ok; the blob is authenticated before anything is decrypted
+	SafeBlobStatus DeserializeFromTransport ( const uint8_t* transportKey, const uint8_t* blob, size_t len )
+	{
+		uint8_t plain [ VALUE_SIZE ];
+		SafeBlobStatus status = SafeSealedBlob::Open ( transportKey, blob, len, plain, VALUE_SIZE );
+		if ( status == SafeBlobStatus::Ok ) {
+			SetFromBytes ( plain );
+			SecureWipe ( plain, VALUE_SIZE );
+		}
+		return status;
+	}
+
+	// Counts as a write: the value is stored under fresh keystream slices
 	bool Deserialize ( const uint8_t* data, size_t len )
 	{
 		if ( len != VALUE_SIZE + 12 + VALUE_SIZE ) return false;
 
-		// Extract nonce
-		std::memcpy ( nonce.data ( ), data, 12 );
+		uint8_t fullKey [ 32 ] = { };
+		std::memcpy ( fullKey, data + 12, VALUE_SIZE < 32 ? VALUE_SIZE : 32 );
 
-		// Extract key (to ensure consistency during deserialization)
-		std::memcpy ( key.data ( ), data + 12, VALUE_SIZE );
-
-		// Extract encrypted payload
-		std::array<uint8_t, VALUE_SIZE> encrypted;
-		std::memcpy ( encrypted.data ( ), data + 12 + VALUE_SIZE, VALUE_SIZE );
-
-		// Decrypt into buffer
-		ChaCha20::Encrypt ( encrypted.data ( ), buffer.data ( ), VALUE_SIZE, key.data ( ), nonce.data ( ) );
+		T value;
+		ChaCha20::Encrypt ( data + 12 + VALUE_SIZE, reinterpret_cast< uint8_t* >( &value ), VALUE_SIZE, fullKey, data );
+		Set ( value );
 
+		SecureWipe ( fullKey, sizeof ( fullKey ) );
+		SecureWipe ( &value, VALUE_SIZE );
 		return true;
 	}
 
@@ -670,18 +2685,37 @@ public:
 	{
 		if ( realMemory ) {
 			// Securely clear memory
+			Arena ( ).EnsureOpen ( );
 			std::memset ( realMemory, 0, VALUE_SIZE );
-			RealMemoryAllocator::FreeRealMemory ( realMemory );
+			Arena ( ).Free ( realMemory, VALUE_SIZE );
 			realMemory = nullptr;
 		}
 
 		// Clear sensitive data
 		buffer.fill ( 0 );
-		key.fill ( 0 );
-		nonce.fill ( 0 );
+		keyPosition = 0;
+		shadowPosition = 0;
 		fakeMemoryAddress = 0;
 	}
 };
 
 template<typename T>
-MemoryPool SafeVar<T>::memoryPool;
\ No newline at end of file
+MemoryPool SafeVar<T>::memoryPool;
+
+template<typename T>
+std::atomic<bool> SafeVar<T>::hashTagsEnabled { false };
+
+template<typename T>
+std::atomic<typename SafeVar<T>::QuarantineWriteHandler> SafeVar<T>::quarantineWriteHandler { nullptr };
+
+namespace std
+{
+	template<typename T>
+	struct hash<SafeVar<T>>
+	{
+		size_t operator()( const SafeVar<T>& var ) const
+		{
+			return static_cast< size_t >( var.HashTag ( ) );
+		}
+	};
+}
\ No newline at end of file
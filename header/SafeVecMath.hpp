@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "SafeVar.hpp"
+#include "SafeParallel.hpp"
+
+/**
+ * @file    SafeVecMath.hpp
+ * @brief   Protected vectors, quaternions and transforms stored as one encrypted SIMD record.
+ *
+ * Three SafeVar<float> per position cost three decryptions and three encryptions per update.
+ * SafeVec3, SafeVec4, SafeQuat and SafeTransform keep all components in one 16-byte aligned
+ * record (48 bytes for a transform) behind a single SafeVar, so a read is one decryption into
+ * SafeFloat4, a value that loads into an SSE register with one aligned load.
+ *
+ * Arithmetic runs on the plain SafeFloat4 values. An expression such as
+ *
+ *   position += velocity * dt;
+ *
+ * decrypts each protected operand once, computes in registers and encrypts the result once.
+ * Compound assignments and Update() read with SafeVar::Peek, since the write that follows
+ * re-keys the value anyway; otherwise they behave like Get() followed by Set(), quarantine
+ * included. UpdateBatch() applies the same update to an array of records,
+ * optionally spread over SafeBulk chunks.
+ *
+ * SSE is used when SAFEVAR_CHACHA_SSE2 is available (always on x64); other targets use the
+ * scalar fallbacks with the same results.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+// Plain four-float value; vectors leave w at 0, quaternions are (x, y, z, w) with w the real part
+struct alignas( 16 ) SafeFloat4
+{
+	float x, y, z, w;
+
+#ifdef SAFEVAR_CHACHA_SSE2
+	__m128 Simd ( ) const { return _mm_load_ps ( &x ); }
+
+	static SafeFloat4 FromSimd ( __m128 v )
+	{
+		SafeFloat4 result;
+		_mm_store_ps ( &result.x, v );
+		return result;
+	}
+#endif
+};
+
+inline SafeFloat4 operator+( const SafeFloat4& a, const SafeFloat4& b )
+{
+#ifdef SAFEVAR_CHACHA_SSE2
+	return SafeFloat4::FromSimd ( _mm_add_ps ( a.Simd ( ), b.Simd ( ) ) );
+#else
+	return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+#endif
+}
+
+inline SafeFloat4 operator-( const SafeFloat4& a, const SafeFloat4& b )
+{
+#ifdef SAFEVAR_CHACHA_SSE2
+	return SafeFloat4::FromSimd ( _mm_sub_ps ( a.Simd ( ), b.Simd ( ) ) );
+#else
+	return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+#endif
+}
+
+// Component-wise product
+inline SafeFloat4 operator*( const SafeFloat4& a, const SafeFloat4& b )
+{
+#ifdef SAFEVAR_CHACHA_SSE2
+	return SafeFloat4::FromSimd ( _mm_mul_ps ( a.Simd ( ), b.Simd ( ) ) );
+#else
+	return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
+#endif
+}
+
+inline SafeFloat4 operator*( const SafeFloat4& a, float s )
+{
+#ifdef SAFEVAR_CHACHA_SSE2
+	return SafeFloat4::FromSimd ( _mm_mul_ps ( a.Simd ( ), _mm_set1_ps ( s ) ) );
+#else
+	return { a.x * s, a.y * s, a.z * s, a.w * s };
+#endif
+}
+
+inline SafeFloat4 operator*( float s, const SafeFloat4& a ) { return a * s; }
+
+inline SafeFloat4 operator-( const SafeFloat4& a ) { return a * -1.0f; }
+
+inline float SafeDot3 ( const SafeFloat4& a, const SafeFloat4& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float SafeDot4 ( const SafeFloat4& a, const SafeFloat4& b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline float SafeLength3 ( const SafeFloat4& a ) { return std::sqrt ( SafeDot3 ( a, a ) ); }
+
+inline SafeFloat4 SafeCross3 ( const SafeFloat4& a, const SafeFloat4& b )
+{
+#ifdef SAFEVAR_CHACHA_SSE2
+	__m128 va = a.Simd ( ), vb = b.Simd ( );
+	__m128 aYzx = _mm_shuffle_ps ( va, va, _MM_SHUFFLE ( 3, 0, 2, 1 ) );
+	__m128 bYzx = _mm_shuffle_ps ( vb, vb, _MM_SHUFFLE ( 3, 0, 2, 1 ) );
+	__m128 c = _mm_sub_ps ( _mm_mul_ps ( va, bYzx ), _mm_mul_ps ( aYzx, vb ) );
+	return SafeFloat4::FromSimd ( _mm_shuffle_ps ( c, c, _MM_SHUFFLE ( 3, 0, 2, 1 ) ) );
+#else
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.0f };
+#endif
+}
+
+// Unit-length copy of the xyz part (w cleared); zero vectors stay zero
+inline SafeFloat4 SafeNormalize3 ( const SafeFloat4& a )
+{
+	float length = SafeLength3 ( a );
+	if ( length == 0.0f ) return { 0.0f, 0.0f, 0.0f, 0.0f };
+	SafeFloat4 result = a * ( 1.0f / length );
+	result.w = 0.0f;
+	return result;
+}
+
+// Hamilton product: rotation b followed by rotation a
+inline SafeFloat4 SafeQuatMultiply ( const SafeFloat4& a, const SafeFloat4& b )
+{
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	};
+}
+
+// Rotate vector v by unit quaternion q
+inline SafeFloat4 SafeQuatRotate ( const SafeFloat4& q, const SafeFloat4& v )
+{
+	SafeFloat4 axis = { q.x, q.y, q.z, 0.0f };
+	SafeFloat4 t = SafeCross3 ( axis, v ) * 2.0f;
+	SafeFloat4 result = v + t * q.w + SafeCross3 ( axis, t );
+	result.w = 0.0f;
+	return result;
+}
+
+struct alignas( 16 ) SafeTransformValue
+{
+	SafeFloat4 position;
+	SafeFloat4 rotation;             // unit quaternion
+	SafeFloat4 scale;
+
+	SafeFloat4 TransformPoint ( const SafeFloat4& point ) const
+	{
+		return position + SafeQuatRotate ( rotation, scale * point );
+	}
+};
+
+/**
+ * @brief Shared storage of the protected SIMD records: one SafeVar<Value> per object.
+ *
+ * Get() is the full SafeVar read (re-key, quarantine). Update() and UpdateBatch() decrypt with
+ * Peek, let fn modify the plain value and store it back: one decryption and one encryption.
+ * A quarantined record updates its fallback value and the write is handled by SafeVar::Set
+ * (dropped or passed to the quarantine handler); a failed check goes through Get(), so it
+ * quarantines or throws exactly as a read would.
+ */
+template<typename Derived, typename Value>
+class SafeSimdVar
+{
+protected:
+	SafeVar<Value> storage;
+
+	// Get() semantics without Get()'s re-key on the common path
+	static Value ReadForUpdate ( const SafeVar<Value>& var )
+	{
+		Value value;
+		if ( !var.IsQuarantined ( ) && var.Peek ( value ) == SafeVarStatus::Ok ) {
+			return value;
+		}
+		return var.Get ( );
+	}
+
+	SafeSimdVar ( ) = default;
+	explicit SafeSimdVar ( const Value& value ) : storage ( value ) { }
+
+public:
+	Value Get ( ) const { return storage.Get ( ); }
+	void Set ( const Value& value ) { storage.Set ( Derived::Canonical ( value ) ); }
+	operator Value( ) const { return Get ( ); }
+
+	Derived& operator=( const Value& value )
+	{
+		Set ( value );
+		return static_cast< Derived& >( *this );
+	}
+
+	template<typename Fn>
+	void Update ( Fn&& fn )
+	{
+		Value value = ReadForUpdate ( storage );
+		fn ( value );
+		Set ( value );
+		SecureWipe ( &value, sizeof ( value ) );
+	}
+
+	/**
+	 * Apply fn(Value&) to count records. The next record is prefetched while the current one
+	 * is decrypted. With options the array is split into SafeBulk chunks on an executor.
+	 */
+	template<typename Fn>
+	static void UpdateBatch ( Derived* records, size_t count, Fn fn, const SafeBulkOptions* options = nullptr )
+	{
+		auto body = [ records, &fn ] ( size_t begin, size_t end ) {
+			for ( size_t i = begin; i < end; ++i ) {
+#ifdef SAFEVAR_CHACHA_SSE2
+				if ( i + 1 < end ) _mm_prefetch ( reinterpret_cast< const char* >( &records [ i + 1 ] ), _MM_HINT_T0 );
+#endif
+				records [ i ].Update ( fn );
+			}
+		};
+
+		if ( options ) {
+			SafeBulk::ForEachChunk ( count, *options, body );
+		}
+		else {
+			body ( 0, count );
+		}
+	}
+
+	// The protecting SafeVar, for validation, sweepers and attachments
+	SafeVar<Value>& Storage ( ) { return storage; }
+	const SafeVar<Value>& Storage ( ) const { return storage; }
+};
+
+class SafeVec3 : public SafeSimdVar<SafeVec3, SafeFloat4>
+{
+	friend class SafeSimdVar<SafeVec3, SafeFloat4>;
+
+	static SafeFloat4 Canonical ( SafeFloat4 value )
+	{
+		value.w = 0.0f;
+		return value;
+	}
+
+public:
+	SafeVec3 ( ) = default;
+	SafeVec3 ( float x, float y, float z ) : SafeSimdVar ( SafeFloat4 { x, y, z, 0.0f } ) { }
+	SafeVec3 ( const SafeFloat4& value ) : SafeSimdVar ( Canonical ( value ) ) { }
+
+	using SafeSimdVar::operator=;
+
+	void Set ( float x, float y, float z ) { storage.Set ( SafeFloat4 { x, y, z, 0.0f } ); }
+	using SafeSimdVar::Set;
+
+	SafeVec3& operator+=( const SafeFloat4& delta ) { Update ( [ &delta ] ( SafeFloat4& v ) { v = v + delta; } ); return *this; }
+	SafeVec3& operator-=( const SafeFloat4& delta ) { Update ( [ &delta ] ( SafeFloat4& v ) { v = v - delta; } ); return *this; }
+	SafeVec3& operator*=( float s ) { Update ( [ s ] ( SafeFloat4& v ) { v = v * s; } ); return *this; }
+
+	float Length ( ) const
+	{
+		SafeFloat4 value = Get ( );
+		float length = SafeLength3 ( value );
+		SecureWipe ( &value, sizeof ( value ) );
+		return length;
+	}
+};
+
+class SafeVec4 : public SafeSimdVar<SafeVec4, SafeFloat4>
+{
+	friend class SafeSimdVar<SafeVec4, SafeFloat4>;
+
+	static const SafeFloat4& Canonical ( const SafeFloat4& value ) { return value; }
+
+public:
+	SafeVec4 ( ) = default;
+	SafeVec4 ( float x, float y, float z, float w ) : SafeSimdVar ( SafeFloat4 { x, y, z, w } ) { }
+	SafeVec4 ( const SafeFloat4& value ) : SafeSimdVar ( value ) { }
+
+	using SafeSimdVar::operator=;
+
+	SafeVec4& operator+=( const SafeFloat4& delta ) { Update ( [ &delta ] ( SafeFloat4& v ) { v = v + delta; } ); return *this; }
+	SafeVec4& operator-=( const SafeFloat4& delta ) { Update ( [ &delta ] ( SafeFloat4& v ) { v = v - delta; } ); return *this; }
+	SafeVec4& operator*=( float s ) { Update ( [ s ] ( SafeFloat4& v ) { v = v * s; } ); return *this; }
+};
+
+class SafeQuat : public SafeSimdVar<SafeQuat, SafeFloat4>
+{
+	friend class SafeSimdVar<SafeQuat, SafeFloat4>;
+
+	static const SafeFloat4& Canonical ( const SafeFloat4& value ) { return value; }
+
+public:
+	static constexpr SafeFloat4 Identity ( ) { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+
+	SafeQuat ( ) : SafeSimdVar ( Identity ( ) ) { }
+	SafeQuat ( const SafeFloat4& value ) : SafeSimdVar ( value ) { }
+
+	// Rotation of angle radians around a unit axis
+	static SafeFloat4 FromAxisAngle ( const SafeFloat4& axis, float angle )
+	{
+		float s = std::sin ( angle * 0.5f );
+		return { axis.x * s, axis.y * s, axis.z * s, std::cos ( angle * 0.5f ) };
+	}
+
+	using SafeSimdVar::operator=;
+
+	// Apply rotation after the current one
+	SafeQuat& operator*=( const SafeFloat4& rotation )
+	{
+		Update ( [ &rotation ] ( SafeFloat4& q ) { q = SafeQuatMultiply ( rotation, q ); } );
+		return *this;
+	}
+
+	SafeFloat4 Rotate ( const SafeFloat4& v ) const
+	{
+		SafeFloat4 q = Get ( );
+		SafeFloat4 result = SafeQuatRotate ( q, v );
+		SecureWipe ( &q, sizeof ( q ) );
+		return result;
+	}
+
+	// Counter drift from repeated composition
+	void Normalize ( )
+	{
+		Update ( [ ] ( SafeFloat4& q ) {
+			float length = std::sqrt ( SafeDot4 ( q, q ) );
+			q = length == 0.0f ? Identity ( ) : q * ( 1.0f / length );
+		} );
+	}
+};
+
+class SafeTransform : public SafeSimdVar<SafeTransform, SafeTransformValue>
+{
+	friend class SafeSimdVar<SafeTransform, SafeTransformValue>;
+
+	static const SafeTransformValue& Canonical ( const SafeTransformValue& value ) { return value; }
+
+public:
+	static SafeTransformValue Identity ( )
+	{
+		return { { 0.0f, 0.0f, 0.0f, 0.0f }, SafeQuat::Identity ( ), { 1.0f, 1.0f, 1.0f, 0.0f } };
+	}
+
+	SafeTransform ( ) : SafeSimdVar ( Identity ( ) ) { }
+	SafeTransform ( const SafeTransformValue& value ) : SafeSimdVar ( value ) { }
+
+	using SafeSimdVar::operator=;
+
+	void Translate ( const SafeFloat4& delta ) { Update ( [ &delta ] ( SafeTransformValue& t ) { t.position = t.position + delta; } ); }
+	void Rotate ( const SafeFloat4& rotation ) { Update ( [ &rotation ] ( SafeTransformValue& t ) { t.rotation = SafeQuatMultiply ( rotation, t.rotation ); } ); }
+
+	SafeFloat4 TransformPoint ( const SafeFloat4& point ) const
+	{
+		SafeTransformValue t = Get ( );
+		SafeFloat4 result = t.TransformPoint ( point );
+		SecureWipe ( &t, sizeof ( t ) );
+		return result;
+	}
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#include "SafeVar.hpp"
+
+/**
+ * @file    SafeWire.hpp
+ * @brief   Batch SafeVar updates straight from network packet buffers.
+ *
+ * Authoritative stat updates arrive as packed (entity, field, value) records:
+ *
+ *   uint32_t entity | uint16_t field | value bytes
+ *
+ * little-endian and without padding. The value size is a property of the field, so a field
+ * id must be bound to the same value type for every entity. SafeWireSchema maps the records
+ * to SafeVars, and SetFromWire() encrypts each value directly from the receive buffer into
+ * its variable (SafeVar::SetFromBytes), without unpacking into temporaries.
+ *
+ * Records are resolved in batches of BATCH_RECORDS first, so the destination variables are
+ * prefetched while the per-thread keystream cache hands out slices generated four blocks at
+ * a time. The consumed part of the packet is wiped before SetFromWire() returns.
+ *
+ * Bind and Unbind must not run concurrently with SetFromWire() on the same schema.
+ *
+ * @author  Christian Louis Abrigo ( YeXiuPH )
+ * @copyright
+ *   Copyright (c) 2025 YXGames. All rights reserved.
+ */
+
+enum class SafeWireStatus : uint8_t
+{
+	Ok,
+	Truncated,          // the packet ends inside a record
+	UnknownField        // a field id with no binding; its size, and so the next record, is unknown
+};
+
+struct SafeWireResult
+{
+	SafeWireStatus status = SafeWireStatus::Ok;
+	size_t applied = 0;             // records written to a SafeVar
+	size_t skipped = 0;             // records of known fields for entities without a binding
+	size_t consumed = 0;            // bytes read (and wiped) from the packet
+};
+
+class SafeWireSchema
+{
+public:
+	static constexpr size_t RECORD_HEADER = sizeof ( uint32_t ) + sizeof ( uint16_t );
+	static constexpr size_t BATCH_RECORDS = 16;
+
+private:
+	using ApplyFn = void ( * )( void* var, const uint8_t* value );
+
+	struct Binding
+	{
+		void* var;
+		ApplyFn apply;
+	};
+
+	std::unordered_map<uint64_t, Binding> bindings;
+	std::unordered_map<uint16_t, uint32_t> fieldSizes;
+
+	static uint64_t Key ( uint32_t entity, uint16_t field )
+	{
+		return ( static_cast< uint64_t >( entity ) << 16 ) | field;
+	}
+
+	template<typename T>
+	static void Apply ( void* var, const uint8_t* value )
+	{
+		static_cast< SafeVar<T>* >( var )->SetFromBytes ( value );
+	}
+
+	friend SafeWireResult SetFromWire ( uint8_t* packet, size_t length, const SafeWireSchema& schema );
+
+public:
+	SafeWireSchema ( ) = default;
+	SafeWireSchema ( const SafeWireSchema& ) = delete;
+	SafeWireSchema& operator=( const SafeWireSchema& ) = delete;
+
+	// Route (entity, field) records to var, which must outlive its binding
+	template<typename T>
+	void Bind ( uint32_t entity, uint16_t field, SafeVar<T>& var )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "Wire values must be trivially copyable." );
+
+		auto size = fieldSizes.find ( field );
+		if ( size == fieldSizes.end ( ) ) {
+			fieldSizes [ field ] = static_cast< uint32_t >( sizeof ( T ) );
+		}
+		else if ( size->second != sizeof ( T ) ) {
+			throw std::runtime_error ( "SafeWireSchema: field already bound with a different value size" );
+		}
+		bindings [ Key ( entity, field ) ] = { &var, &Apply<T> };
+	}
+
+	// Records for an unbound entity are skipped as long as their field stays known
+	void Unbind ( uint32_t entity, uint16_t field )
+	{
+		bindings.erase ( Key ( entity, field ) );
+	}
+
+	size_t Size ( ) const { return bindings.size ( ); }
+};
+
+/**
+ * Apply every record in packet[0, length) to the bound SafeVars, then wipe the consumed bytes.
+ * Stops at the first malformed record and reports it in the result; records before it stay
+ * applied.
+ */
+inline SafeWireResult SetFromWire ( uint8_t* packet, size_t length, const SafeWireSchema& schema )
+{
+	struct Pending
+	{
+		const SafeWireSchema::Binding* binding;
+		const uint8_t* value;
+	};
+
+	SafeWireResult result;
+	Pending batch [ SafeWireSchema::BATCH_RECORDS ];
+	size_t offset = 0;
+
+	while ( offset < length && result.status == SafeWireStatus::Ok ) {
+		// Resolve a batch of records before writing any of them
+		size_t count = 0;
+		while ( count < SafeWireSchema::BATCH_RECORDS && offset < length ) {
+			if ( length - offset < SafeWireSchema::RECORD_HEADER ) {
+				result.status = SafeWireStatus::Truncated;
+				break;
+			}
+
+			uint32_t entity;
+			uint16_t field;
+			std::memcpy ( &entity, packet + offset, sizeof ( entity ) );
+			std::memcpy ( &field, packet + offset + sizeof ( entity ), sizeof ( field ) );
+
+			auto size = schema.fieldSizes.find ( field );
+			if ( size == schema.fieldSizes.end ( ) ) {
+				result.status = SafeWireStatus::UnknownField;
+				break;
+			}
+			if ( length - offset - SafeWireSchema::RECORD_HEADER < size->second ) {
+				result.status = SafeWireStatus::Truncated;
+				break;
+			}
+
+			const uint8_t* value = packet + offset + SafeWireSchema::RECORD_HEADER;
+			offset += SafeWireSchema::RECORD_HEADER + size->second;
+
+			auto binding = schema.bindings.find ( SafeWireSchema::Key ( entity, field ) );
+			if ( binding == schema.bindings.end ( ) ) {
+				++result.skipped;
+				continue;
+			}
+
+#ifdef SAFEVAR_CHACHA_SSE2
+			_mm_prefetch ( static_cast< const char* >( binding->second.var ), _MM_HINT_T0 );
+#endif
+			batch [ count++ ] = { &binding->second, value };
+		}
+
+		for ( size_t i = 0; i < count; ++i ) {
+			batch [ i ].binding->apply ( batch [ i ].binding->var, batch [ i ].value );
+		}
+		result.applied += count;
+	}
+
+	result.consumed = offset;
+	SecureWipe ( packet, offset );
+	return result;
+}